@@ -48,6 +48,13 @@ File::File(internal::StateInitializer *init) :
   fromFile(init->in.release()),
   currentWritePath(init->path),
   canWrite(init->canWrite),
+  chunkSize(streams::BufferPool::chunkSize()),
+  flushSize(streams::FileOutputStream::DEFAULT_FLUSH_SIZE),
+  parallelWrite(false),
+  directWrite(false),
+  asyncWrite(true),
+  writeBudget(0),
+  executor(init->executor),
   SIFA{} {
 
     // release complex builtin types
@@ -67,9 +74,22 @@ File::File(internal::StateInitializer *init) :
         auto t = init->enums[i];
         const_cast<AbstractEnumPool **>(enums)[i] = t;
     }
+
+    // generated accessors load deferred fields of this file and record
+    // changes of blocks copied from it from now on
+    for (AbstractPool *p : *this)
+        for (DataField *df : p->dataFields)
+            if (!df->isLoaded() || !df->sources.empty())
+                if (Declarations *const d = df->declarations())
+                    d->add(df);
 }
 
 File::~File() {
+    // accessors must not find fields of this file anymore
+    for (AbstractPool *p : *this)
+        for (DataField *df : p->dataFields)
+            df->withdraw();
+
     for (size_t i = 0; i < classCount; i++) {
         delete classes[i];
     }
@@ -130,6 +150,10 @@ void File::check() {
 void File::changePath(std::string path) {
     if (currentWritePath != path) {
         currentWritePath = path;
+
+        // strings equal to known strings must not be written twice
+        if (!canWrite)
+            strings->intern();
         canWrite = true;
     }
 }
@@ -234,26 +258,106 @@ void File::loadLazyData() {
     // ensure that strings are loaded
     ((StringPool *)strings)->loadLazyData();
 
-    // ensure that lazy fields have been loaded
+    // ensure that lazy fields and fields outside the projection have been
+    // loaded and that no block will be copied from the file
+    std::vector<DataField *> lazy;
     for (AbstractPool *p : *this) {
-        for (DataField *df : p->dataFields)
-            if (auto f = dynamic_cast<LazyField *>(df))
-                f->ensureIsLoaded();
+        for (DataField *df : p->dataFields) {
+            if (!df->isLoaded())
+                lazy.push_back(df);
+            df->dropSources();
+        }
     }
+    DataField::ensureAreLoaded(lazy, *executor);
 
     // close the file input stream and ensure that it is not read again
     delete fromFile;
     fromFile = nullptr;
 }
 
+void File::loadWrittenLazyData() {
+    if (!fromFile)
+        return;
+
+    // strings are renumbered on write
+    ((StringPool *)strings)->loadLazyData();
+
+    bool copied = false;
+    std::vector<DataField *> lazy;
+    for (AbstractPool *p : *this) {
+        for (DataField *df : p->dataFields) {
+            const auto f = dynamic_cast<LazyField *>(df);
+            if (f) {
+                if (f->canCopyBlocks())
+                    copied = true;
+                else
+                    lazy.push_back(f);
+            }
+
+            if (!df->sources.empty()) {
+                // blocks change with the layout of the owner or of referenced
+                // objects
+                const auto t = dynamic_cast<const AbstractPool *>(df->type);
+                if (p->modified() || (t && t->base->modified()))
+                    df->dropSources();
+                else
+                    copied = true;
+            }
+
+            // fields outside the projection are written from their objects,
+            // unless all of their blocks are copied
+            if (!f && !df->isLoaded() &&
+                (df->sources.empty() || df->changedSinceRead()))
+                lazy.push_back(df);
+        }
+    }
+    DataField::ensureAreLoaded(lazy, *executor);
+
+    // the file input stream is still required, if blocks are copied from it
+    if (!copied) {
+        delete fromFile;
+        fromFile = nullptr;
+    }
+}
+
 void File::flush() {
     if (!canWrite)
         throw std::invalid_argument("this file is read-only");
 
-    loadLazyData();
+    // blocks cannot be copied from a file while it is being overwritten
+    if (fromFile && fromFile->backedBy(currentPath()))
+        loadLazyData();
+    else
+        loadWrittenLazyData();
+
+    streams::FileOutputStream out(currentPath(), flushSize, directWrite,
+                                  asyncWrite);
+    writeTo(out);
+}
+
+void File::flush(std::vector<uint8_t> &buffer) {
+    if (!canWrite)
+        throw std::invalid_argument("this file is read-only");
+
+    loadWrittenLazyData();
+
+    streams::FileOutputStream out(buffer);
+    writeTo(out);
+}
+
+void File::flush(streams::ChunkList &chunks) {
+    if (!canWrite)
+        throw std::invalid_argument("this file is read-only");
+
+    loadWrittenLazyData();
+
+    streams::FileOutputStream out(chunks);
+    writeTo(out);
+}
 
-    streams::FileOutputStream out(currentPath());
+void File::writeTo(streams::FileOutputStream &out) {
     internal::Writer write(this, out);
+    out.close();
 }
 
 void File::close() {
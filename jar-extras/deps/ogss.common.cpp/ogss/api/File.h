@@ -22,6 +22,11 @@ class Writer;
 struct StateInitializer;
 } // namespace internal
 
+namespace streams {
+class ChunkList;
+class FileOutputStream;
+} // namespace streams
+
 namespace api {
 
 /**
@@ -100,7 +105,81 @@ class File {
 
     File(internal::StateInitializer *init);
 
+    //! write the state to out and close it
+    void writeTo(streams::FileOutputStream &out);
+
+    /**
+     * Load lazy data required by a write that does not change the file we
+     * read from. The encoded blocks of other lazy fields and unchanged blocks
+     * of other fields are copied from fromFile on write.
+     */
+    void loadWrittenLazyData();
+
   public:
+    /**
+     * The size of buffers used to serialize data on flush. Larger chunks
+     * reduce the number of buffers per field at the cost of memory.
+     *
+     * @note chunks are recycled per power of two; other sizes are rounded up
+     */
+    size_t chunkSize;
+
+    /**
+     * The maximum number of bytes handed to the OS at once on flush.
+     */
+    size_t flushSize;
+
+    /**
+     * If true, each data block is written on flush by the task that produced
+     * it at a file offset reserved once the block is complete. This lets
+     * output bandwidth scale with the number of cores, but the order of
+     * blocks in the file depends on scheduling.
+     *
+     * @note ignored on platforms without positional writes
+     */
+    bool parallelWrite;
+
+    /**
+     * If true, flush writes the file bypassing the page cache in aligned
+     * blocks of flushSize bytes. This keeps large flushes from evicting the
+     * pages of other files.
+     *
+     * @note ignored if the platform or file system does not support direct
+     * I/O
+     * @note takes precedence over parallelWrite
+     */
+    bool directWrite;
+
+    /**
+     * If true, flush submits blocks to an asynchronous I/O engine, i.e.
+     * io_uring, instead of waiting for each write. Writes fall back to
+     * blocking calls if the engine is unavailable or directWrite is set.
+     */
+    bool asyncWrite;
+
+    /**
+     * The maximum number of encoded bytes waiting to be written on flush.
+     * Tasks encoding data blocks wait while the limit is exceeded, i.e. it
+     * bounds the memory used by flush at the cost of parallelism. Zero means
+     * no limit.
+     *
+     * @note the limit can be exceeded by one block per thread
+     * @note flushes to memory retain all blocks regardless
+     */
+    size_t writeBudget;
+
+    /**
+     * Runs the jobs of flush and loadLazyData. Defaults to the executor the
+     * file was opened with, i.e. to concurrent::Pool::shared(), unless the
+     * caller passed its own. A pool with fewer workers limits the threads
+     * used by this file.
+     *
+     * @note the executor must outlive all uses by this file
+     * @note flush and loadLazyData must not be called from a job of an
+     * executor with a single worker, because they wait for their own jobs
+     */
+    concurrent::Executor *executor;
+
     /**
      * Will release resources of this file, but will *NOT* write changes to
      * disk!
@@ -209,13 +288,17 @@ class File {
     void check();
 
     /**
-     * Force all lazy string and field data to be loaded from disk.
+     * Force all lazy string and field data to be loaded from disk. This
+     * includes fields outside the projection the file was opened with.
      */
     void loadLazyData();
 
     /**
      * Write changes to disk.
      *
+     * @note blocks of fields that have not been changed since they were read
+     * are copied from the file read instead of being encoded, unless that file
+     * is overwritten
      * @note this will not sync the file to disk, but it will block until all
      * in-memory changes are written to buffers.
      * @note if check fails, then the state is guaranteed to be unmodified
@@ -225,6 +308,26 @@ class File {
      */
     void flush();
 
+    /**
+     * Write changes to the end of buffer instead of the current path.
+     *
+     * @note otherwise, same as flush()
+     */
+    void flush(std::vector<uint8_t> &buffer);
+
+    /**
+     * Write changes to chunks instead of the current path. The chunks
+     * holding the serialized state are moved to the list without copying
+     * them. Hence, its segments can be handed to writev, sendmsg or vmsplice
+     * directly.
+     *
+     * @note large strings and unchanged field blocks are referenced rather
+     * than copied; hence, chunks must not be used after this file has been
+     * deleted or its lazy data has been loaded
+     * @note otherwise, same as flush()
+     */
+    void flush(streams::ChunkList &chunks);
+
     /**
      * Same as flush, changeMode(readOnly).
      */
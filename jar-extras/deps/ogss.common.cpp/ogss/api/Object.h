@@ -9,6 +9,8 @@
 
 namespace ogss {
 namespace internal {
+class DataField;
+
 class DistributedField;
 
 class FieldDeclaration;
@@ -76,6 +78,8 @@ class Object {
 
     friend class internal::FieldDeclaration;
 
+    friend class internal::DataField;
+
     friend class internal::DistributedField;
 
     friend class internal::LazyField;
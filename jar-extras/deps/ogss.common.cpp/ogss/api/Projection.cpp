@@ -0,0 +1,13 @@
+//
+// Created on 17.10.26.
+//
+
+#include "Projection.h"
+#include "../internal/AbstractPool.h"
+#include "../internal/FieldDeclaration.h"
+
+using namespace ogss::api;
+
+Projection &Projection::add(const internal::FieldDeclaration *field) {
+    return add(*field->owner->name, *field->name);
+}
@@ -0,0 +1,71 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_API_PROJECTION_H
+#define OGSS_COMMON_API_PROJECTION_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "String.h"
+
+namespace ogss {
+namespace internal {
+class FieldDeclaration;
+}
+namespace api {
+
+/**
+ * Selects the fields decoded when a file is opened. Blocks of other fields
+ * are left in the file untouched. They are decoded by File::loadLazyData,
+ * by DataField::ensureIsLoaded or by a flush that cannot copy them.
+ *
+ * @note names are the names used in the file, e.g. AbstractField::name
+ * @note generated accessors and reflective access load fields outside the
+ * projection before using them
+ */
+class Projection final {
+    //! types all fields of which are selected
+    std::unordered_set<std::string> types;
+
+    //! selected fields by name of their type
+    std::unordered_map<std::string, std::unordered_set<std::string>> fields;
+
+  public:
+    Projection() : types(), fields() {}
+
+    //! select all fields of type
+    Projection &add(const std::string &type) {
+        types.insert(type);
+        return *this;
+    }
+
+    //! select the field of type
+    Projection &add(const std::string &type, const std::string &field) {
+        fields[type].insert(field);
+        return *this;
+    }
+
+    /**
+     * select the field behind a handle, e.g. a field of a file of the same
+     * specification opened before
+     */
+    Projection &add(const internal::FieldDeclaration *field);
+
+    /**
+     * @return true, iff the field of type is decoded on open
+     */
+    bool contains(String type, String field) const {
+        if (types.count(*type))
+            return true;
+
+        const auto fs = fields.find(*type);
+        return fs != fields.end() && fs->second.count(*field);
+    }
+};
+} // namespace api
+} // namespace ogss
+
+#endif // OGSS_COMMON_API_PROJECTION_H
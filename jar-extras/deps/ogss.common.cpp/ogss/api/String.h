@@ -19,6 +19,38 @@ namespace ogss {
 
         using ogss::api::String;
 
+        /**
+         * A non-owning view of a string image, e.g. of a string stored in a
+         * mapped file.
+         *
+         * @note a view is valid as long as its source is valid
+         */
+        struct StringView {
+            const char *data;
+            size_t size;
+
+            //! materialize the viewed image
+            std::string str() const {
+                return std::string(data, size);
+            }
+
+            bool operator==(const StringView &o) const {
+                return size == o.size && 0 == std::char_traits<char>::compare(data, o.data, size);
+            }
+
+            bool operator!=(const StringView &o) const {
+                return !(*this == o);
+            }
+
+            bool operator==(const std::string &o) const {
+                return size == o.size() && 0 == o.compare(0, size, data, size);
+            }
+
+            bool operator!=(const std::string &o) const {
+                return !(*this == o);
+            }
+        };
+
         /**
          * OGSS-comparison of strings
          */
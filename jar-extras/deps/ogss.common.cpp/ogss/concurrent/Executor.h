@@ -0,0 +1,106 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_CPP_CONCURRENT_EXECUTOR_H
+#define OGSS_COMMON_CPP_CONCURRENT_EXECUTOR_H
+
+#include <cstddef>
+
+namespace ogss {
+namespace concurrent {
+
+/**
+ * A job to be executed by the pool. This is a very explicit alternative to
+ * lambda expressions. We use it here, because lambda-based approaches tend to
+ * have non-obvious semantics and we want to keep our architecture similar to
+ * architectures of other OGSS implementations. Also, the combination of
+ * emplace, references, lambdas, friends, pointer to members and life times can
+ * yield messy solutions.
+ *
+ * @author Timm Felden
+ */
+struct Job {
+    /**
+     * called once the Job has finished execution and is hence removed from the
+     * pool
+     * @note the thread executing the destructor is not specified
+     * @note if the executing pool is deleted before run was called, the job
+     * will be deleted without ever calling run
+     */
+    virtual ~Job() = default;
+
+    /// this action is called from an arbitrary worker thread
+    virtual void run() = 0;
+};
+
+/**
+ * Runs the jobs of parsers, writers and lazy loads. An executor can be shared
+ * by any number of files. Hence, its clients track the completion and errors
+ * of their jobs themselves, and a job must not use its client after it
+ * signalled completion.
+ *
+ * @note jobs may wait for the thread that started them, but never for other
+ * jobs; hence, any executor with at least one thread makes progress
+ */
+class Executor {
+  public:
+    virtual ~Executor() = default;
+
+    /**
+     * transfer ownership of a heap allocated job to this executor; it will be
+     * run once and deleted afterwards
+     * @note can be called from multiple threads, including the threads of
+     * this executor
+     * @note running nullptr has no effect
+     */
+    virtual void run(Job *job) = 0;
+
+    /**
+     * @return the number of jobs that can run at the same time
+     */
+    virtual size_t parallelism() const = 0;
+
+    //! the node passed to runOn by jobs that can run anywhere
+    static constexpr size_t ANY_NODE = ~(size_t)0;
+
+    /**
+     * @return the number of NUMA nodes jobs can be placed on; 1, if the
+     * executor does not place jobs
+     */
+    virtual size_t nodes() const { return 1; }
+
+    /**
+     * Run job on a thread of the argument NUMA node, so that memory touched
+     * first by the job is allocated on that node. The node is a hint; it is
+     * ignored by executors that do not place jobs.
+     *
+     * @note node must be less than nodes() or ANY_NODE
+     */
+    virtual void runOn(size_t node, Job *job) { run(job); }
+
+    /**
+     * @return the node of the element at index, if count elements are
+     * spread over nodes in contiguous ranges of equal size
+     */
+    size_t nodeOf(size_t index, size_t count) const {
+        const size_t n = nodes();
+        if (n < 2 || !count)
+            return 0;
+        const size_t r = index * n / count;
+        return r < n ? r : n - 1;
+    }
+
+    /**
+     * @return the index of the first element of node, if count elements are
+     * spread over nodes in contiguous ranges of equal size
+     */
+    size_t nodeBegin(size_t node, size_t count) const {
+        const size_t n = nodes();
+        return (node * count + n - 1) / n;
+    }
+};
+} // namespace concurrent
+} // namespace ogss
+
+#endif // OGSS_COMMON_CPP_CONCURRENT_EXECUTOR_H
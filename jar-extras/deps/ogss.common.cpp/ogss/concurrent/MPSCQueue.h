@@ -0,0 +1,119 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_CPP_CONCURRENT_MPSCQUEUE_H
+#define OGSS_COMMON_CPP_CONCURRENT_MPSCQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace ogss {
+namespace concurrent {
+
+/**
+ * A multi-producer single-consumer queue. Producers push without locking.
+ * The consumer takes all pushed elements at once and blocks if there are
+ * none; producers take the lock only to wake up a sleeping consumer.
+ *
+ * @note elements are taken in the order they were pushed by each producer
+ */
+template <typename T> class MPSCQueue final {
+    struct Node {
+        Node *next;
+        T value;
+    };
+
+    //! pushed elements, newest first
+    std::atomic<Node *> pushed;
+
+    //! true, while the consumer waits for elements
+    std::atomic<bool> sleeping;
+
+    std::mutex mx;
+    std::condition_variable cv;
+
+    //! elements taken by the consumer, oldest first
+    Node *taken;
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mx);
+        // a producer either sees sleeping or we see its element
+        sleeping.store(true);
+        while (!pushed.load())
+            cv.wait(lock);
+        sleeping.store(false);
+    }
+
+  public:
+    MPSCQueue() : pushed(nullptr), sleeping(false), mx(), cv(), taken(nullptr) {}
+
+    MPSCQueue(const MPSCQueue &) = delete;
+
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    ~MPSCQueue() {
+        for (Node *n = pushed.load(); n;) {
+            Node *const next = n->next;
+            delete n;
+            n = next;
+        }
+        for (Node *n = taken; n;) {
+            Node *const next = n->next;
+            delete n;
+            n = next;
+        }
+    }
+
+    /**
+     * Add an element.
+     * @note can be called by multiple threads
+     */
+    void push(const T &value) {
+        Node *const n = new Node{nullptr, value};
+        Node *h = pushed.load(std::memory_order_relaxed);
+        do {
+            n->next = h;
+        } while (!pushed.compare_exchange_weak(h, n));
+
+        if (sleeping.load()) {
+            std::lock_guard<std::mutex> lock(mx);
+            cv.notify_one();
+        }
+    }
+
+    /**
+     * Take the next element; waits until there is one.
+     * @note must only be called by a single thread
+     */
+    T pop() {
+        while (!taken) {
+            Node *h = pushed.exchange(nullptr);
+            if (!h) {
+                wait();
+                continue;
+            }
+
+            // restore the order of pushes
+            Node *r = nullptr;
+            while (h) {
+                Node *const next = h->next;
+                h->next = r;
+                r = h;
+                h = next;
+            }
+            taken = r;
+        }
+
+        Node *const n = taken;
+        taken = n->next;
+        const T r = n->value;
+        delete n;
+        return r;
+    }
+};
+} // namespace concurrent
+} // namespace ogss
+
+#endif // OGSS_COMMON_CPP_CONCURRENT_MPSCQUEUE_H
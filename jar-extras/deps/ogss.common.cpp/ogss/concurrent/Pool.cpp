@@ -5,61 +5,51 @@
 #include "Pool.h"
 #include "../utils.h"
 
+#include <algorithm>
+#include <fstream>
+
+#ifdef __linux__
+#include <cstdio>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 using namespace ogss::concurrent;
 
-Pool::Pool() :
-  workerCount(std::thread::hardware_concurrency()),
-  workers(new std::thread *[workerCount]),
+thread_local Pool::Worker *Pool::current = nullptr;
+
+// odr-used by std::min
+constexpr size_t Pool::BATCH;
+
+Pool::Pool(size_t threads, bool numa) :
+  Pool(threads, numa ? numaNodes(threads) : std::vector<std::vector<int>>()) {}
+
+Pool::Pool(size_t threads, std::vector<std::vector<int>> &&nodes) :
+  workerCount(std::max<size_t>(1, threads)),
+  workers(new Worker[workerCount]),
+  nodeCount(std::max<size_t>(1, nodes.size())),
+  places(new Node[nodeCount]),
   mx(),
-  cv(),
-  jobs(),
+  injected(),
+  injectedCount(0),
+  nextNode(0),
   errors(),
+  erroneous(false),
   shutdown(false) {
+    for (size_t i = 0; i < nodes.size(); i++)
+        places[i].cpus.swap(nodes[i]);
+
+    // all deques exist before the first worker tries to steal
     for (size_t i = 0; i < workerCount; i++) {
-        workers[i] = new std::thread(
-          [](Pool *const p) {
-              while (true) {
-                  Job *next;
-                  // we have just been created or completed a job, so get the
-                  // next job
-                  {
-                      std::unique_lock<std::mutex> lock(p->mx);
-                      // on while instead of if: threads can be woken up
-                      // accidentally
-                      // @see https://en.wikipedia.org/wiki/Spurious_wakeup
-                      while (!p->shutdown & p->jobs.empty())
-                          p->cv.wait(lock);
-
-                      // prefer shutdown over the next job
-                      if (p->shutdown)
-                          return;
-
-                      // no shutdown, so there must be a job
-                      next = p->jobs.front();
-                      p->jobs.pop_front();
-                  }
-
-                  // try execute
-                  try {
-                      next->run();
-                  } catch (std::exception &e) {
-                      p->errors.emplace_back(e.what());
-                  } catch (...) {
-                      p->errors.emplace_back("run threw a non std::exception");
-                  }
-
-                  // try delete
-                  try {
-                      delete next;
-                  } catch (std::exception &e) {
-                      p->errors.emplace_back(e.what());
-                  } catch (...) {
-                      p->errors.emplace_back(
-                        "delete threw a non std::exception");
-                  }
-              }
-          },
-          this);
+        workers[i].pool = this;
+        workers[i].node = i % nodeCount;
+    }
+
+    for (size_t i = 0; i < workerCount; i++) {
+        workers[i].thread = new std::thread(
+          [](Pool *const p, Worker *const w) { p->work(*w); }, this,
+          workers + i);
     }
 }
 
@@ -68,23 +58,353 @@ Pool::~Pool() {
         std::lock_guard<std::mutex> lock(mx);
         shutdown = true;
     }
-    cv.notify_all();
+    for (size_t i = 0; i < nodeCount; i++)
+        places[i].cv.notify_all();
 
     // wait for workers to terminate
     for (size_t i = 0; i < workerCount; i++) {
-        auto w = workers[i];
+        auto w = workers[i].thread;
         w->join();
         delete w;
     }
 
-    delete[] workers;
-
     // delete remaining jobs
-    for (Job *j : jobs)
+    for (size_t i = 0; i < workerCount; i++)
+        while (Job *j = workers[i].jobs.pop())
+            delete j;
+    for (size_t i = 0; i < nodeCount; i++)
+        for (Job *j : places[i].placed)
+            delete j;
+    for (Job *j : injected)
         delete j;
+
+    delete[] places;
+    delete[] workers;
+}
+
+void Pool::runAll(Job *const *js, size_t count) {
+    Worker *const w = current;
+    size_t started = 0;
+    if (w && this == w->pool) {
+        // a job of ours spawns jobs; they can be stolen by other workers
+        for (size_t i = 0; i < count; i++) {
+            if (js[i]) {
+                w->jobs.push(js[i]);
+                started++;
+            }
+        }
+        if (started)
+            wake(w->node, started, true);
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(mx);
+            for (size_t i = 0; i < count; i++) {
+                if (js[i]) {
+                    injected.push_back(js[i]);
+                    started++;
+                }
+            }
+            injectedCount.fetch_add(started);
+        }
+        if (started)
+            wake(nextNode.fetch_add(1, std::memory_order_relaxed) % nodeCount,
+                 started, true);
+    }
+}
+
+void Pool::runOn(size_t node, Job *job) {
+    if (ANY_NODE == node || 1 == nodeCount) {
+        run(job);
+        return;
+    }
+    if (!job)
+        return;
+
+    node %= nodeCount;
+    Worker *const w = current;
+    if (w && this == w->pool && node == w->node) {
+        w->jobs.push(job);
+    } else {
+        Node &n = places[node];
+        std::lock_guard<std::mutex> lock(mx);
+        n.placed.push_back(job);
+        n.placedCount.fetch_add(1);
+    }
+    wake(node, 1, false);
+}
+
+void Pool::work(Worker &w) {
+    current = &w;
+
+#ifdef __linux__
+    const std::vector<int> &cpus = places[w.node].cpus;
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : cpus)
+            CPU_SET(c, &set);
+        // a worker that cannot be pinned still works
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+
+    while (Job *next = this->next(w)) {
+        // try execute
+        try {
+            next->run();
+        } catch (std::exception &e) {
+            error(e.what());
+        } catch (...) {
+            error("run threw a non std::exception");
+        }
+
+        // try delete
+        try {
+            delete next;
+        } catch (std::exception &e) {
+            error(e.what());
+        } catch (...) {
+            error("delete threw a non std::exception");
+        }
+    }
+    current = nullptr;
+}
+
+Job *Pool::next(Worker &w) {
+    unsigned spins = 0;
+    // prefer shutdown over the next job
+    while (!shutdown.load(std::memory_order_relaxed)) {
+        // other nodes are helped only if there is nothing to do on ours
+        if (Job *r = find(w, 1 == nodeCount || spins >= SPINS / 2))
+            return r;
+
+        if (++spins < SPINS) {
+            std::this_thread::yield();
+        } else {
+            park(w);
+            spins = 0;
+        }
+    }
+    return nullptr;
+}
+
+Job *Pool::find(Worker &w, bool remote) {
+    if (Job *r = w.jobs.pop())
+        return r;
+
+    Node &n = places[w.node];
+    if (n.placedCount.load(std::memory_order_relaxed))
+        if (Job *r = take(w, n.placed, n.placedCount, false))
+            return r;
+
+    if (injectedCount.load(std::memory_order_relaxed))
+        if (Job *r = take(w, injected, injectedCount, true))
+            return r;
+
+    // start behind w, so that thieves do not compete for the same deque
+    const size_t self = &w - workers;
+    for (size_t i = 1; i < workerCount; i++) {
+        Worker &v = workers[(self + i) % workerCount];
+        if (remote || v.node == w.node)
+            if (Job *r = v.jobs.steal())
+                return r;
+    }
+    return nullptr;
+}
+
+Job *Pool::take(Worker &w, std::deque<Job *> &queue, std::atomic<size_t> &count,
+                bool spill) {
+    Job *r;
+    size_t batch;
+    {
+        std::lock_guard<std::mutex> lock(mx);
+        const size_t n = queue.size();
+        if (!n)
+            return nullptr;
+
+        // leave jobs for other workers
+        batch = std::min(BATCH, (n + workerCount - 1) / workerCount);
+        r = queue.front();
+
+        // push in reverse, so that w runs the batch in queue order
+        for (size_t i = batch - 1; i != 0; i--)
+            w.jobs.push(queue[i]);
+        queue.erase(queue.begin(), queue.begin() + batch);
+        count.fetch_sub(batch);
+    }
+
+    // the rest of the batch can be stolen
+    if (batch > 1)
+        wake(w.node, batch - 1, spill);
+    return r;
+}
+
+bool Pool::hasJobs(const Worker &w) const {
+    if (injectedCount.load() || places[w.node].placedCount.load())
+        return true;
+    for (size_t i = 0; i < workerCount; i++)
+        if (!workers[i].jobs.empty())
+            return true;
+    return false;
+}
+
+void Pool::park(Worker &w) {
+    Node &n = places[w.node];
+
+    // either a thread starting a job sees that we are idle or we see its job
+    n.idle.fetch_add(1);
+    if (hasJobs(w)) {
+        n.idle.fetch_sub(1);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mx);
+    // on while instead of if: threads can be woken up accidentally
+    // @see https://en.wikipedia.org/wiki/Spurious_wakeup
+    while (!n.wakeups && !shutdown.load(std::memory_order_relaxed))
+        n.cv.wait(lock);
+    if (n.wakeups)
+        n.wakeups--;
+    n.idle.fetch_sub(1);
+}
+
+void Pool::wake(size_t node, size_t count, bool spill) {
+    for (size_t i = 0; count && i < nodeCount; i++) {
+        if (i && !spill)
+            return;
+
+        Node &n = places[(node + i) % nodeCount];
+        const size_t parked = n.idle.load();
+        if (!parked)
+            continue;
+
+        size_t woken;
+        {
+            std::lock_guard<std::mutex> lock(mx);
+            if (n.wakeups >= parked)
+                continue;
+            woken = std::min(count, parked - n.wakeups);
+            n.wakeups += woken;
+        }
+        if (1 == woken)
+            n.cv.notify_one();
+        else
+            n.cv.notify_all();
+        count -= woken;
+    }
 }
 
 void Pool::takeErrors(std::vector<std::string> &errors) {
     std::lock_guard<std::mutex> lock(mx);
     errors.swap(this->errors);
+    erroneous.store(!this->errors.empty(), std::memory_order_release);
+}
+
+void Pool::error(const char *message) {
+    std::lock_guard<std::mutex> lock(mx);
+    errors.emplace_back(message);
+    erroneous.store(true, std::memory_order_release);
+}
+
+std::vector<std::vector<int>> Pool::numaNodes(size_t threads) {
+    std::vector<std::vector<int>> r;
+#ifdef __linux__
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed))
+        return r;
+
+    DIR *const dir = opendir("/sys/devices/system/node");
+    if (!dir)
+        return r;
+    std::vector<int> ids;
+    while (const dirent *e = readdir(dir)) {
+        int id;
+        char tail;
+        if (1 == sscanf(e->d_name, "node%d%c", &id, &tail))
+            ids.push_back(id);
+    }
+    closedir(dir);
+    std::sort(ids.begin(), ids.end());
+
+    for (int id : ids) {
+        // a list of CPUs and ranges of CPUs, e.g. "0-7,16-23"
+        std::ifstream f("/sys/devices/system/node/node" + std::to_string(id) +
+                        "/cpulist");
+        std::vector<int> cpus;
+        std::string range;
+        while (std::getline(f, range, ',')) {
+            int first, last;
+            const int n = sscanf(range.c_str(), "%d-%d", &first, &last);
+            if (n < 1)
+                continue;
+            if (1 == n)
+                last = first;
+            for (int c = first; c <= last && c < CPU_SETSIZE; c++)
+                if (CPU_ISSET(c, &allowed))
+                    cpus.push_back(c);
+        }
+        if (!cpus.empty())
+            r.push_back(std::move(cpus));
+    }
+#endif
+
+    // each node requires a worker
+    if (r.size() > threads)
+        r.resize(threads);
+    if (r.size() < 2)
+        r.clear();
+    return r;
+}
+
+#ifdef __linux__
+//! @return the CPU quota of the cgroup of this process; 0, if there is none
+static size_t cgroupCPUs() {
+    double quota = -1, period = 0;
+
+    // cgroup v2: "$MAX $PERIOD", where $MAX may be "max"
+    {
+        std::ifstream f("/sys/fs/cgroup/cpu.max");
+        std::string max;
+        if (f >> max >> period && max != "max")
+            quota = std::stod(max);
+    }
+
+    // cgroup v1: a quota of -1 means no limit
+    if (quota < 0) {
+        std::ifstream q("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+        std::ifstream p("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+        if (!(q >> quota && p >> period))
+            quota = -1;
+    }
+
+    if (quota <= 0 || period <= 0)
+        return 0;
+
+    // a partial CPU still requires a thread
+    return std::max<size_t>(1, (size_t)(quota / period + 0.5));
+}
+#endif
+
+size_t Pool::defaultWorkers() {
+    size_t r = std::thread::hardware_concurrency();
+
+#ifdef __linux__
+    cpu_set_t set;
+    if (0 == sched_getaffinity(0, sizeof(set), &set)) {
+        const size_t allowed = CPU_COUNT(&set);
+        if (allowed && (!r || allowed < r))
+            r = allowed;
+    }
+
+    const size_t quota = cgroupCPUs();
+    if (quota && (!r || quota < r))
+        r = quota;
+#endif
+
+    return std::max<size_t>(1, r);
+}
+
+Pool &Pool::shared() {
+    static Pool pool;
+    return pool;
 }
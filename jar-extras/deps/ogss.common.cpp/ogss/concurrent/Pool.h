@@ -5,9 +5,14 @@
 #ifndef OGSS_COMMON_CPP_CONCURRENT_POOL_H
 #define OGSS_COMMON_CPP_CONCURRENT_POOL_H
 
+#include "Executor.h"
+#include "WorkStealingDeque.h"
+
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -15,53 +20,148 @@ namespace ogss {
 namespace concurrent {
 
 /**
- * A job to be executed by the pool. This is a very explicit alternative to
- * lambda expressions. We use it here, because lambda-based approaches tend to
- * have non-obvious semantics and we want to keep our architecture similar to
- * architectures of other OGSS implementations. Also, the combination of
- * emplace, references, lambdas, friends, pointer to members and life times can
- * yield messy solutions.
+ * A fix-sized pool of worker threads to execute non-blocking jobs.
+ * Exceptions raised by jobs will be accumulated in the pool. As a pool can be
+ * shared by several files, their parsers and writers catch errors of their
+ * jobs themselves.
+ *
+ * Each worker owns a deque of jobs. Jobs started by a job are pushed to the
+ * deque of its worker without locking; idle workers steal from the deques of
+ * others. Jobs started by other threads are injected into a shared queue from
+ * which workers take them in batches. Workers that find no job spin for a
+ * while before they park.
+ *
+ * In NUMA mode, workers are pinned to the CPUs of their node. Jobs placed on
+ * a node are queued per node and run by its workers; workers steal from
+ * other nodes only after they found no job on their own node for a while.
  *
  * @author Timm Felden
  */
-struct Job {
-    /**
-     * called once the Job has finished execution and is hence removed from the
-     * pool
-     * @note the thread executing the destructor is not specified
-     * @note if the executing pool is deleted before run was called, the job
-     * will be deleted without ever calling run
-     */
-    virtual ~Job() = default;
+class Pool final : public Executor {
+    //! a worker thread and the jobs started by its jobs
+    struct Worker {
+        Pool *pool;
+        //! the NUMA node of this worker
+        size_t node;
+        WorkStealingDeque<Job> jobs;
+        std::thread *thread;
 
-    /// this action is called from an arbitrary worker thread
-    virtual void run() = 0;
-};
+        Worker() : pool(nullptr), node(0), jobs(), thread(nullptr) {}
+    };
+
+    //! the jobs and parked workers of a NUMA node
+    struct Node {
+        //! the CPUs of the node; empty, if workers are not pinned
+        std::vector<int> cpus;
+
+        //! jobs placed on this node by threads that are not its workers
+        std::deque<Job *> placed;
+
+        //! the size of placed; can be read without holding mx
+        std::atomic<size_t> placedCount;
+
+        //! the number of workers that are parked or about to park
+        std::atomic<size_t> idle;
+
+        //! the number of parked workers that may leave park
+        size_t wakeups;
+
+        //! notified, if wakeups is raised or on shutdown
+        std::condition_variable cv;
+
+        Node() : cpus(), placed(), placedCount(0), idle(0), wakeups(0), cv() {}
+    };
+
+    //! the worker running on the current thread; nullptr, if none
+    static thread_local Worker *current;
 
-/**
- * A fix-sized pool of worker threads to execute non-blocking jobs.
- * The pool is intended to be used inside a single OGFile.
- * Therefore, exceptions raised by jobs will be accumulated in the pool.
- *
- * @author Timm Felden
- */
-class Pool final {
     const size_t workerCount;
-    std::thread **const workers;
+    Worker *const workers;
 
+    const size_t nodeCount;
+    Node *const places;
+
+    //! protects injected, placed, wakeups and errors
     std::mutex mx;
-    std::condition_variable cv;
 
-    std::deque<Job *> jobs;
+    //! jobs started by threads that are not workers of this pool
+    std::deque<Job *> injected;
+
+    //! the size of injected; can be read without holding mx
+    std::atomic<size_t> injectedCount;
+
+    //! the node whose workers are woken first for the next injected jobs
+    std::atomic<size_t> nextNode;
 
     //! if an exception would otherwise kill a worker thread, it is enqueued
     //! here instead
     std::vector<std::string> errors;
 
-    bool shutdown;
+    //! true, iff errors is not empty; can be read without holding mx
+    std::atomic<bool> erroneous;
+
+    std::atomic<bool> shutdown;
+
+    //! number of unsuccessful searches for a job before a worker parks
+    static constexpr unsigned SPINS = 64;
+
+    //! the maximum number of queued jobs taken by a worker at once
+    static constexpr size_t BATCH = 32;
+
+    //! create workers on the nodes given by their CPUs
+    Pool(size_t threads, std::vector<std::vector<int>> &&nodes);
+
+    /**
+     * @return the CPUs of the NUMA nodes available to this process; empty, if
+     * there are less than two or the platform does not tell
+     * @note at most threads nodes are returned
+     */
+    static std::vector<std::vector<int>> numaNodes(size_t threads);
+
+    //! add an error message of a job
+    void error(const char *message);
+
+    //! run jobs on w until shutdown
+    void work(Worker &w);
+
+    //! @return the next job of w; nullptr on shutdown
+    Job *next(Worker &w);
+
+    /**
+     * @return a job of w, of its node, of injected or stolen from another
+     * worker; nullptr, if none was found
+     * @param remote if true, steal from workers of other nodes, too
+     */
+    Job *find(Worker &w, bool remote);
+
+    /**
+     * move a batch of the jobs of queue to w; @return the first of them
+     * @param spill if true, parked workers of other nodes may be woken to
+     * steal the batch
+     */
+    Job *take(Worker &w, std::deque<Job *> &queue, std::atomic<size_t> &count,
+              bool spill);
+
+    //! @return false, if there is no job to be found by w
+    bool hasJobs(const Worker &w) const;
+
+    //! wait until woken up or shutdown
+    void park(Worker &w);
+
+    /**
+     * wake up to n parked workers of node
+     * @param spill if true, wake workers of other nodes, if there are not
+     * enough parked workers on node
+     */
+    void wake(size_t node, size_t n, bool spill);
 
   public:
-    Pool();
+    /**
+     * create a pool with the argument number of worker threads; at least one
+     * @param numa if true, workers are spread over the NUMA nodes of the host
+     * and jobs can be placed on nodes; ignored, if there is a single node
+     */
+    explicit Pool(size_t threads = defaultWorkers(), bool numa = false);
 
     /**
      * shutdown the pool
@@ -75,42 +175,61 @@ class Pool final {
      * @note the job submitted must terminate eventually. Otherwise, the pool
      * will not shut down
      * @note running nullptr has no effect
+     * @note jobs started by a job of this pool do not take a lock
      */
-    void run(Job *job) {
-        if (job) {
-            {
-                std::lock_guard<std::mutex> lock(mx);
-                jobs.push_back(job);
-            }
-            cv.notify_one();
-        }
-    }
+    void run(Job *job) final { runAll(&job, 1); }
+
+    /**
+     * Start count jobs at once. In essence the same as run for each of them
+     * but with a single lock and wakeup for the whole batch.
+     */
+    void runAll(Job *const *js, size_t count);
 
     /**
-     * Start all argument jobs at once. In essence the same as run for each
-     * element of the argument iterable but with reduced communication overhead
-     * if more jobs than std::thread::hardware_concurrency are submitted.
+     * Start all argument jobs at once.
+     * @see runAll(Job *const *, size_t)
      */
     template <typename C> void runAll(C js) {
-        {
-            std::lock_guard<std::mutex> lock(mx);
-            for (Job *j : js) {
-                if (j)
-                    jobs.push_back(j);
-            }
+        std::vector<Job *> batch;
+        for (Job *j : js) {
+            if (j)
+                batch.push_back(j);
         }
-        cv.notify_all();
+        runAll(batch.data(), batch.size());
     }
 
+    size_t parallelism() const final { return workerCount; }
+
+    size_t nodes() const final { return nodeCount; }
+
+    /**
+     * @note a job placed on a node is run by the workers of that node; jobs it
+     * starts with run may be stolen by other nodes
+     */
+    void runOn(size_t node, Job *job) final;
+
     /**
      * Check if the pool holds errors.
      */
-    bool hasErrors() const { return !errors.empty(); }
+    bool hasErrors() const { return erroneous.load(std::memory_order_acquire); }
 
     /**
      * Take all error messages.
      */
     void takeErrors(std::vector<std::string> &errors);
+
+    /**
+     * @return the number of CPUs available to this process, i.e. the
+     * hardware concurrency bounded by the CPU affinity and the CPU quota of
+     * its cgroup
+     */
+    static size_t defaultWorkers();
+
+    /**
+     * The pool used by files that are not given an executor. It is created
+     * on first use with defaultWorkers threads.
+     */
+    static Pool &shared();
 };
 } // namespace concurrent
 } // namespace ogss
@@ -6,6 +6,10 @@
 #define OGSS_COMMON_CPP_CONCURRENT_SEMAPHORE_H
 
 #include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
 
 namespace ogss {
     namespace concurrent {
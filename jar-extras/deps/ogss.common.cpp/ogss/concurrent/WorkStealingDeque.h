@@ -0,0 +1,141 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_CPP_CONCURRENT_WORKSTEALINGDEQUE_H
+#define OGSS_COMMON_CPP_CONCURRENT_WORKSTEALINGDEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ogss {
+namespace concurrent {
+
+/**
+ * A Chase-Lev deque of pointers. Its owner pushes and pops at the bottom
+ * without locking; other threads steal from the top. A steal takes the oldest
+ * element, i.e. the owner keeps working on the elements it pushed last.
+ *
+ * @note push and pop must only be called by the owner
+ * @note arrays replaced on growth are kept until the deque is destroyed,
+ * because thieves may still read from them
+ */
+template <typename T> class WorkStealingDeque final {
+    struct Array {
+        const int64_t mask;
+        std::unique_ptr<std::atomic<T *>[]> slots;
+
+        explicit Array(int64_t capacity) :
+          mask(capacity - 1), slots(new std::atomic<T *>[capacity]) {}
+
+        T *get(int64_t i) const {
+            return slots[i & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t i, T *v) {
+            slots[i & mask].store(v, std::memory_order_relaxed);
+        }
+    };
+
+    //! the index of the oldest element; advanced by pop and steal
+    std::atomic<int64_t> top;
+
+    //! the index behind the newest element; changed by the owner only
+    std::atomic<int64_t> bottom;
+
+    std::atomic<Array *> array;
+
+    //! all arrays of this deque; owned by the owner
+    std::vector<std::unique_ptr<Array>> arrays;
+
+    //! replace a full array by one twice its size
+    Array *grow(Array *a, int64_t t, int64_t b) {
+        Array *const r = new Array(2 * (a->mask + 1));
+        arrays.emplace_back(r);
+        for (int64_t i = t; i < b; i++)
+            r->put(i, a->get(i));
+        array.store(r, std::memory_order_release);
+        return r;
+    }
+
+  public:
+    explicit WorkStealingDeque(int64_t capacity = 256) :
+      top(0), bottom(0), array(), arrays() {
+        arrays.emplace_back(new Array(capacity));
+        array.store(arrays.back().get());
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    /**
+     * Add v at the bottom.
+     * @note the store of bottom is sequentially consistent, so that a thread
+     * announcing that it goes to sleep either sees v or is seen by the owner
+     */
+    void push(T *v) {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        const int64_t t = top.load(std::memory_order_acquire);
+        Array *a = array.load(std::memory_order_relaxed);
+        if (b - t > a->mask)
+            a = grow(a, t, b);
+        a->put(b, v);
+        bottom.store(b + 1);
+    }
+
+    /**
+     * Take the newest element.
+     * @return nullptr, if the deque is empty or the last element was stolen
+     */
+    T *pop() {
+        const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array *const a = array.load(std::memory_order_relaxed);
+        bottom.store(b);
+        int64_t t = top.load();
+        if (t > b) {
+            // empty
+            bottom.store(b + 1);
+            return nullptr;
+        }
+
+        T *r = a->get(b);
+        if (t == b) {
+            // the last element; race with thieves
+            if (!top.compare_exchange_strong(t, t + 1))
+                r = nullptr;
+            bottom.store(b + 1);
+        }
+        return r;
+    }
+
+    /**
+     * Take the oldest element.
+     * @return nullptr, if the deque is empty or another thread took the
+     * element first
+     * @note can be called by any thread
+     */
+    T *steal() {
+        int64_t t = top.load();
+        const int64_t b = bottom.load();
+        if (t >= b)
+            return nullptr;
+
+        Array *const a = array.load(std::memory_order_acquire);
+        T *const r = a->get(t);
+        return top.compare_exchange_strong(t, t + 1) ? r : nullptr;
+    }
+
+    /**
+     * @return true, iff the deque seems to be empty
+     * @note the result is outdated immediately, unless called by the owner
+     */
+    bool empty() const { return bottom.load() <= top.load(); }
+};
+} // namespace concurrent
+} // namespace ogss
+
+#endif // OGSS_COMMON_CPP_CONCURRENT_WORKSTEALINGDEQUE_H
@@ -5,6 +5,8 @@
 #ifndef SKILL_CPP_COMMON_BUILTINFIELDTYPE_H
 #define SKILL_CPP_COMMON_BUILTINFIELDTYPE_H
 
+#include <algorithm>
+
 #include "FieldType.h"
 #include "../utils.h"
 #include "../api/types.h"
@@ -43,31 +45,84 @@ namespace ogss {
             }
         };
 
+        /**
+         * stateless field types with a fixed size, i.e. all that are validated
+         * once per block
+         */
+        template<typename T, TypeID id,
+                api::Box Read(InStream &),
+                api::Box ReadChecked(InStream &),
+                bool Write(api::Box, streams::BufferedOutStream *)>
+        struct FixedSizeFieldType : StatelessFieldType<T, id, Read, Write> {
+            FixedSizeFieldType() : StatelessFieldType<T, id, Read, Write>() {}
+
+            void rs(streams::InStream &in, api::Box *target, size_t count) const override {
+                in.require(sizeof(T) * count);
+                while (count-- != 0)
+                    *(target++) = ReadChecked(in);
+            }
+        };
+
         struct BoolFieldType : public StatelessFieldType<bool, 0, InStream::boolBox,
                 BufferedOutStream::boolBox> {
+            void rs(streams::InStream &in, api::Box *target, size_t count) const override {
+                bool vs[InStream::BULK_SIZE];
+                while (count != 0) {
+                    const size_t n = std::min((size_t) InStream::BULK_SIZE, count);
+                    in.booleans(vs, n);
+                    for (size_t j = 0; j < n; j++) {
+                        api::Box r = {0};
+                        r.boolean = vs[j];
+                        target[j] = r;
+                    }
+                    target += n;
+                    count -= n;
+                }
+            }
+
+            bool ws(const api::Box *values, size_t count,
+                    streams::BufferedOutStream *out) const override {
+                bool vs[InStream::BULK_SIZE];
+                bool drop = true;
+                while (count != 0) {
+                    const size_t n = std::min((size_t) InStream::BULK_SIZE, count);
+                    for (size_t j = 0; j < n; j++) {
+                        vs[j] = values[j].boolean;
+                        drop &= !vs[j];
+                    }
+                    out->booleans(vs, n);
+                    values += n;
+                    count -= n;
+                }
+                return drop;
+            }
         };
 
         extern BoolFieldType BoolType;
 
-        struct I8FieldType : public StatelessFieldType<int8_t, 1, InStream::i8Box,
+        struct I8FieldType : public FixedSizeFieldType<int8_t, 1, InStream::i8Box,
+                InStream::i8checkedBox,
                 BufferedOutStream::i8Box> {
         };
 
         extern I8FieldType I8;
 
-        struct I16FieldType : public StatelessFieldType<int16_t, 2, InStream::i16Box,
+        struct I16FieldType : public FixedSizeFieldType<int16_t, 2, InStream::i16Box,
+                InStream::i16checkedBox,
                 BufferedOutStream::i16Box> {
         };
 
         extern I16FieldType I16;
 
-        struct I32FieldType : public StatelessFieldType<int32_t, 3, InStream::i32Box,
+        struct I32FieldType : public FixedSizeFieldType<int32_t, 3, InStream::i32Box,
+                InStream::i32checkedBox,
                 BufferedOutStream::i32Box> {
         };
 
         extern I32FieldType I32;
 
-        struct I64FieldType : public StatelessFieldType<int64_t, 4, InStream::i64Box,
+        struct I64FieldType : public FixedSizeFieldType<int64_t, 4, InStream::i64Box,
+                InStream::i64checkedBox,
                 BufferedOutStream::i64Box> {
         };
 
@@ -75,17 +130,47 @@ namespace ogss {
 
         struct V64FieldType : public StatelessFieldType<int64_t, 5, InStream::v64Box,
                 BufferedOutStream::v64Box> {
+            void rs(streams::InStream &in, api::Box *target, size_t count) const override {
+                int64_t vs[InStream::BULK_SIZE];
+                while (count != 0) {
+                    const size_t n = std::min((size_t) InStream::BULK_SIZE, count);
+                    in.v64s(vs, n);
+                    for (size_t j = 0; j < n; j++)
+                        target[j].i64 = vs[j];
+                    target += n;
+                    count -= n;
+                }
+            }
+
+            bool ws(const api::Box *values, size_t count,
+                    streams::BufferedOutStream *out) const override {
+                int64_t vs[InStream::BULK_SIZE];
+                bool drop = true;
+                while (count != 0) {
+                    const size_t n = std::min((size_t) InStream::BULK_SIZE, count);
+                    for (size_t j = 0; j < n; j++) {
+                        vs[j] = values[j].i64;
+                        drop &= !vs[j];
+                    }
+                    out->v64s(vs, n);
+                    values += n;
+                    count -= n;
+                }
+                return drop;
+            }
         };
 
         extern V64FieldType V64;
 
-        struct F32FieldType : public StatelessFieldType<float, 6, InStream::i32Box,
+        struct F32FieldType : public FixedSizeFieldType<float, 6, InStream::i32Box,
+                InStream::i32checkedBox,
                 BufferedOutStream::i32Box> {
         };
 
         extern F32FieldType F32;
 
-        struct F64FieldType : public StatelessFieldType<double, 7, InStream::i64Box,
+        struct F64FieldType : public FixedSizeFieldType<double, 7, InStream::i64Box,
+                InStream::i64checkedBox,
                 BufferedOutStream::i64Box> {
         };
 
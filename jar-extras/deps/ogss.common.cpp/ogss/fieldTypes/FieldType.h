@@ -39,12 +39,36 @@ namespace ogss {
              */
             virtual api::Box r(streams::InStream &in) const = 0;
 
+            /**
+             * read count boxes from a stream into target
+             *
+             * @note types with a known worst-case size validate the whole
+             * range once and decode it without further bounds checks
+             */
+            virtual void rs(streams::InStream &in, api::Box *target, size_t count) const {
+                while (count-- != 0)
+                    *(target++) = r(in);
+            }
+
             /**
              * write a box to a stream
              *
              * @return true iff v is a default value
              */
             virtual bool w(api::Box v, streams::BufferedOutStream *out) const = 0;
+
+            /**
+             * write count boxes from values to a stream
+             *
+             * @return true iff all values are default values
+             */
+            virtual bool ws(const api::Box *values, size_t count,
+                            streams::BufferedOutStream *out) const {
+                bool drop = true;
+                while (count-- != 0)
+                    drop &= w(*(values++), out);
+                return drop;
+            }
         };
     }
 }
@@ -5,6 +5,7 @@
 #ifndef SKILL_CPP_COMMON_HULLTYPE_H
 #define SKILL_CPP_COMMON_HULLTYPE_H
 
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 #include <unordered_map>
@@ -137,18 +138,19 @@ class HullType : public FieldType {
         if (!ref)
             return 0;
 
-        ObjectID r;
-        {
-            std::lock_guard<std::mutex> readLock(mapLock);
+        std::lock_guard<std::mutex> readLock(mapLock);
+        return idLocked(ref);
+    }
 
-            ObjectID &rval = IDs[ref];
-            if (!rval) {
-                rval = idMap.size();
-                idMap.push_back((void *)ref);
-            }
-            r = rval;
+  private:
+    //! @note mapLock must be held by the caller; ref must not be null
+    ObjectID idLocked(const void *ref) const {
+        ObjectID &rval = IDs[ref];
+        if (!rval) {
+            rval = idMap.size();
+            idMap.push_back((void *)ref);
         }
-        return r;
+        return rval;
     }
 
   public:
@@ -164,6 +166,31 @@ class HullType : public FieldType {
         return false;
     }
 
+    bool ws(const api::Box *values, size_t count,
+            streams::BufferedOutStream *out) const final {
+        int64_t vs[streams::InStream::BULK_SIZE];
+        bool drop = true;
+        while (count != 0) {
+            const size_t n =
+              std::min((size_t)streams::InStream::BULK_SIZE, count);
+            {
+                // IDs of a whole chunk are assigned under a single lock
+                std::lock_guard<std::mutex> readLock(mapLock);
+                for (size_t j = 0; j < n; j++) {
+                    if (const void *ref = values[j].anyRef) {
+                        vs[j] = idLocked(ref);
+                        drop = false;
+                    } else
+                        vs[j] = 0;
+                }
+            }
+            out->v64s(vs, n);
+            values += n;
+            count -= n;
+        }
+        return drop;
+    }
+
   protected:
     virtual BlockID allocateInstances(int count,
                                       streams::MappedInStream *map) = 0;
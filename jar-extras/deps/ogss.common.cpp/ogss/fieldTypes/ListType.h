@@ -44,12 +44,17 @@ template <typename T> class ListType final : public SingleArgumentType {
 
     void read(ObjectID i, const ObjectID end,
               streams::MappedInStream *in) final {
+        api::Box vs[streams::InStream::BULK_SIZE];
         while (i < end) {
             auto xs = (api::Array<T> *)idMap[++i];
             int s = in->v32();
             xs->reserve(s);
-            while (s-- != 0) {
-                xs->push_back(api::unbox<T>(base->r(*in)));
+            while (s != 0) {
+                const int n = std::min((int)streams::InStream::BULK_SIZE, s);
+                base->rs(*in, vs, n);
+                for (int j = 0; j < n; j++)
+                    xs->push_back(api::unbox<T>(vs[j]));
+                s -= n;
             }
         }
     }
@@ -102,6 +102,40 @@ api::Box AbstractPool::r(streams::InStream &in) const {
     return r;
 }
 
+void AbstractPool::rs(streams::InStream &in, api::Box *target,
+                      size_t count) const {
+    int64_t vs[streams::InStream::BULK_SIZE];
+    while (count != 0) {
+        const size_t n = std::min((size_t)streams::InStream::BULK_SIZE, count);
+        in.v64s(vs, n);
+        for (size_t j = 0; j < n; j++)
+            target[j].anyRef = getAsAnnotation((ObjectID)vs[j]);
+        target += n;
+        count -= n;
+    }
+}
+
+bool AbstractPool::ws(const api::Box *values, size_t count,
+                      streams::BufferedOutStream *out) const {
+    int64_t vs[streams::InStream::BULK_SIZE];
+    bool drop = true;
+    while (count != 0) {
+        const size_t n = std::min((size_t)streams::InStream::BULK_SIZE, count);
+        for (size_t j = 0; j < n; j++) {
+            const auto v = values[j].anyRef;
+            if (v) {
+                vs[j] = v->id;
+                drop = false;
+            } else
+                vs[j] = 0;
+        }
+        out->v64s(vs, n);
+        values += n;
+        count -= n;
+    }
+    return drop;
+}
+
 iterators::StaticFieldIterator internal::AbstractPool::fields() const {
     return iterators::StaticFieldIterator(this);
 }
@@ -6,6 +6,7 @@
 #define SKILL_CPP_COMMON_ABSTRACTSTORAGEPOOL_H
 
 #include <assert.h>
+#include <utility>
 #include <vector>
 
 #include "../common.h"
@@ -75,6 +76,13 @@ class AbstractPool : public fieldTypes::FieldType {
      */
     ObjectID deletedCount = 0;
 
+    /**
+     * deleted instances in static order, i.e. static instances followed by
+     * new objects; bit i is set iff the i-th instance has been deleted
+     * @note grows on demand, i.e. it is empty unless there are deletions
+     */
+    std::vector<uint64_t> deleted;
+
   private:
     /**
      * Delete shall only be called from skill state
@@ -87,6 +95,12 @@ class AbstractPool : public fieldTypes::FieldType {
      */
     inline void free(api::Object *target) {
         // @note we need no null or 0 check, because both happen in SkillState
+        const ObjectID id = target->id;
+        const size_t i = 0 < id ? id - 1 - bpo : staticDataInstances - 1 - id;
+        if (deleted.size() <= i / 64)
+            deleted.resize(i / 64 + 1);
+        deleted[i / 64] |= (uint64_t)1 << (i % 64);
+
         target->id = 0;
         deletedCount++;
     }
@@ -105,7 +119,36 @@ class AbstractPool : public fieldTypes::FieldType {
      * @note internal use only!
      * @note will parallelize over blocks and can be invoked in parallel
      */
-    virtual void allocateInstances() = 0;
+    void allocateInstances() {
+        allocateBook();
+        createInstances(0, staticDataInstances);
+    }
+
+    /**
+     * allocate the memory of the instances read from file without touching it
+     *
+     * @note internal use only!
+     */
+    virtual void allocateBook() = 0;
+
+    /**
+     * create the instances [begin; end[ of this pool read from file in the
+     * memory allocated by allocateBook
+     *
+     * @note internal use only!
+     * @note disjoint ranges can be created in parallel; memory is touched
+     * first by the thread creating its range
+     */
+    virtual void createInstances(ObjectID begin, ObjectID end) = 0;
+
+    /**
+     * @return the memory of the instances read from file as [begin; end[
+     *
+     * @note internal use only!
+     * @note valid until the next write, because the instances read from the
+     * file written include new objects
+     */
+    virtual std::pair<const void *, const void *> instancesRead() const = 0;
 
   public:
     /**
@@ -254,6 +297,22 @@ class AbstractPool : public fieldTypes::FieldType {
         return size;
     }
 
+    /**
+     * @return true, iff instances of this pool or its sub pools have been
+     * created or deleted since the last read or write, i.e. iff the write
+     * will change their layout
+     */
+    bool modified() const {
+        const AbstractPool *p = this;
+        const auto endTHH = THH;
+        do {
+            if (p->deletedCount || p->newObjectsSize())
+                return true;
+            p = p->next;
+        } while (p && endTHH < p->THH);
+        return false;
+    }
+
     iterators::StaticFieldIterator fields() const;
 
     iterators::FieldIterator allFields() const;
@@ -279,6 +338,9 @@ class AbstractPool : public fieldTypes::FieldType {
 
     api::Box r(streams::InStream &in) const final;
 
+    void rs(streams::InStream &in, api::Box *target,
+            size_t count) const final;
+
     bool w(api::Box target, streams::BufferedOutStream *out) const final {
         const auto v = target.anyRef;
         if (v) {
@@ -290,12 +352,17 @@ class AbstractPool : public fieldTypes::FieldType {
         }
     }
 
+    bool ws(const api::Box *values, size_t count,
+            streams::BufferedOutStream *out) const final;
+
     friend class AutoField;
     friend class DataField;
     friend class DistributedField;
 
     friend class Creator;
 
+    friend class Declarations;
+
     friend class Parser;
     friend class ParParser;
     friend class ParReadTask;
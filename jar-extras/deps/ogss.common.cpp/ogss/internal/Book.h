@@ -62,6 +62,9 @@ template <class T> class Book {
         return currentPage;
     }
 
+    //! @return the first page; nullptr, if there is none
+    const T *initialPage() const { return pages.empty() ? nullptr : pages[0]; }
+
     /**
      * return the next free instance
      *
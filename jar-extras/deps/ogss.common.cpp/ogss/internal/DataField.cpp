@@ -0,0 +1,186 @@
+//
+// Created on 17.10.26.
+//
+
+#include "DataField.h"
+#include "../api/Exception.h"
+#include "../concurrent/Semaphore.h"
+#include "../streams/MappedInStream.h"
+
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+
+using namespace ogss;
+using namespace internal;
+
+//! global lock used to synchronize deferred reads
+static std::mutex deferLock;
+
+//! global lock used to synchronize loading deferred blocks
+static std::mutex loadLock;
+
+void DataField::defer(int begin, int end, streams::MappedInStream *in) const {
+    std::lock_guard<std::mutex> m(deferLock);
+
+    std::vector<Chunk> *cs = chunks.load(std::memory_order_relaxed);
+    if (!cs) {
+        cs = new std::vector<Chunk>;
+        chunks.store(cs, std::memory_order_release);
+    }
+    cs->emplace_back(Chunk{begin, end, in});
+}
+
+void DataField::readChunk(const Chunk &c) {
+    const int base = owner->bpo;
+    c.in->willNeed();
+    read(base + c.begin, base + c.end, *c.in);
+
+    if (!c.in->consumed())
+        throw std::out_of_range("deferred read task did not consume InStream");
+    c.in->dontNeed();
+}
+
+void DataField::loaded() {
+    std::vector<Chunk> *const cs = chunks.load(std::memory_order_relaxed);
+    for (Chunk &c : *cs)
+        delete c.in;
+
+    chunks.store(nullptr, std::memory_order_release);
+    delete cs;
+}
+
+void DataField::withdraw() {
+    if (Declarations *const d = declarations())
+        d->remove(this);
+}
+
+void DataField::dropSources() {
+    std::vector<std::pair<const uint8_t *, size_t>>().swap(sources);
+
+    // fields that have not been loaded are withdrawn on load
+    if (isLoaded())
+        withdraw();
+}
+
+bool DataField::changedSinceRead() const {
+    return sourceEpoch &&
+           marks.changed(0, owner->cachedSize - 1, sourceEpoch);
+}
+
+//! loading a field changed before would overwrite the change
+static void checkUnchanged(const DataField *f) {
+    if (f->changedSinceRead())
+        throw Exception("field " + *f->owner->name + "." + *f->name +
+                        " has been changed before it has been loaded");
+}
+
+void DataField::load() {
+    {
+        std::lock_guard<std::mutex> l(loadLock);
+        if (isLoaded())
+            return;
+
+        checkUnchanged(this);
+        for (const Chunk &c : *chunks.load(std::memory_order_relaxed))
+            readChunk(c);
+
+        loaded();
+    }
+    if (Declarations *const d = declarations())
+        d->loaded(this);
+}
+
+//! the state shared by the jobs of ensureAreLoaded
+struct DataField::Load {
+    //! released by each job as its last action
+    concurrent::Semaphore barrier;
+
+    //! protects error
+    std::mutex errorLock;
+
+    //! the first error of a job
+    std::exception_ptr error;
+};
+
+struct DataField::LoadChunk final : public concurrent::Job {
+    Load *const load;
+    DataField *const f;
+    const Chunk *const c;
+
+    LoadChunk(Load *load, DataField *f, const Chunk *c) :
+      load(load), f(f), c(c) {}
+
+    void run() final {
+        concurrent::Semaphore::ScopedPermit release(&load->barrier);
+        try {
+            f->readChunk(*c);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(load->errorLock);
+            if (!load->error)
+                load->error = std::current_exception();
+        }
+    }
+};
+
+void DataField::ensureAreLoaded(const std::vector<DataField *> &fields,
+                                concurrent::Executor &executor) {
+    size_t blocks = 0;
+    for (DataField *f : fields)
+        if (!f->isLoaded()) {
+            checkUnchanged(f);
+            blocks += f->chunks.load(std::memory_order_relaxed)->size();
+        }
+
+    // there is nothing to gain from a single block or thread
+    if (blocks < 2 || executor.parallelism() < 2) {
+        for (DataField *f : fields)
+            f->ensureIsLoaded();
+        return;
+    }
+
+    {
+        // accessors must not load the fields in between
+        std::lock_guard<std::mutex> l(loadLock);
+
+        // blocks of a field are disjoint; strings are loaded, i.e. reading
+        // blocks changes nothing but the data of their fields
+        Load load;
+        int32_t started = 0;
+        for (DataField *f : fields) {
+            if (f->isLoaded())
+                continue;
+
+            // decode blocks on the node that allocated their instances
+            const AbstractPool *const base = f->owner->base;
+            for (const Chunk &c : *f->chunks.load(std::memory_order_relaxed)) {
+                executor.runOn(executor.nodeOf(f->owner->bpo + c.begin,
+                                               base->cachedSize),
+                               new LoadChunk(&load, f, &c));
+                started++;
+            }
+        }
+        load.barrier.takeMany(started);
+
+        if (load.error)
+            std::rethrow_exception(load.error);
+
+        for (DataField *f : fields)
+            if (!f->isLoaded())
+                f->loaded();
+    }
+
+    for (DataField *f : fields)
+        if (Declarations *const d = f->declarations())
+            d->loaded(f);
+}
+
+DataField::~DataField() {
+    // @note File withdraws fields, while declarations() is overridden
+    if (std::vector<Chunk> *const cs = chunks.load()) {
+        for (Chunk &c : *cs) {
+            delete c.in;
+        }
+        delete cs;
+    }
+}
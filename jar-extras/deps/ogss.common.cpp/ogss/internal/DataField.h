@@ -5,13 +5,29 @@
 #ifndef OGSS_TEST_CPP_DATAFIELD_H
 #define OGSS_TEST_CPP_DATAFIELD_H
 
+#include "../concurrent/Executor.h"
 #include "AbstractPool.h"
+#include "Declarations.h"
+#include "DirtyMarks.h"
 #include "FieldDeclaration.h"
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 namespace ogss {
+namespace api {
+class File;
+}
 namespace internal {
+class Parser;
+
+class ParParser;
+
 class ParReadTask;
 
+class SeqParser;
+
 class SeqReadTask;
 
 class Writer;
@@ -26,11 +42,55 @@ class DataField : public FieldDeclaration {
     DataField(const FieldType *const type, api::String const name,
               const TypeID fieldID, AbstractPool *const owner) :
       FieldDeclaration(type, name, fieldID, owner),
-      blocks(0) {
+      chunks(nullptr),
+      blocks(0),
+      sources(),
+      sourceEpoch(0),
+      marks() {
         assert(fieldID);
         owner->dataFields.push_back(this);
     }
 
+    //! a block read from file that has not been decoded yet
+    struct Chunk {
+        //! the range of the chunk relative to the owner, i.e. to its bpo
+        int begin;
+        int end;
+        streams::MappedInStream *in;
+    };
+
+    /**
+     * The blocks that have not been decoded. Lazy fields and fields outside
+     * the projection of the parser decode their blocks on load.
+     * @note nullptr, if the field has been loaded
+     * @note set to nullptr under the lock of load
+     */
+    mutable std::atomic<std::vector<Chunk> *> chunks;
+
+    /**
+     * Keep the block [begin; end[ relative to the owner until the field is
+     * loaded; takes ownership of in.
+     * @note can be invoked in parallel
+     */
+    void defer(int begin, int end, streams::MappedInStream *in) const;
+
+    //! decode the block of c
+    virtual void readChunk(const Chunk &c);
+
+    //! release chunks after all of them have been read
+    void loaded();
+
+    void load();
+
+    //! remove the field from its declarations, if any
+    void withdraw();
+
+    //! blocks are not copied from the file read anymore
+    void dropSources();
+
+    struct Load;
+    struct LoadChunk;
+
     /**
      * Read data from a mapped input stream and set it accordingly. This is
      * invoked at the very end of state construction and done massively in
@@ -51,8 +111,84 @@ class DataField : public FieldDeclaration {
     //! @note this field is initialized on use and has no meaning otherwise
     std::atomic<int32_t> blocks;
 
+    /**
+     * The encoded blocks read from file by block ID. Blocks that have not been
+     * changed since sourceEpoch are copied on write instead of being encoded.
+     * @note empty, if the blocks of this field cannot be copied
+     * @note the bytes belong to the file read
+     */
+    std::vector<std::pair<const uint8_t *, size_t>> sources;
+
+    //! the epoch in which sources or chunks have been read
+    uint32_t sourceEpoch;
+
+    //! the changes made to instances of the owner
+    DirtyMarks marks;
+
+  public:
+    ~DataField() override;
+
+    /**
+     * Record a change of o in this field.
+     * @note new objects change the layout of their pool anyway; hence,
+     * changes of objects without a positive ID are not recorded
+     */
+    inline void markChanged(const api::Object *o) {
+        if (0 < o->id)
+            marks.mark(o->id - 1 - owner->bpo);
+    }
+
+    /**
+     * @return the declarations of this field in all files, i.e. the
+     * declarations used by generated accessors; nullptr, if there are no such
+     * accessors
+     */
+    virtual Declarations *declarations() const { return nullptr; }
+
+    /**
+     * @return true, iff all blocks of the field read from file have been
+     * decoded
+     */
+    inline bool isLoaded() const {
+        return nullptr == chunks.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return true, iff instances of the owner read from file may have been
+     * changed in this field since it has been read
+     */
+    bool changedSinceRead() const;
+
+    /**
+     * @throws Exception as ensureAreLoaded
+     * @note can be invoked in parallel
+     */
+    inline void ensureIsLoaded() {
+        if (!isLoaded())
+            load();
+    }
+
+    /**
+     * Ensure that fields are loaded. Blocks are read in parallel by executor.
+     * @note strings referenced by fields must have been loaded
+     * @throws Exception if a field that has not been loaded has been changed,
+     * e.g. by a generated setter, because loading would overwrite the change
+     */
+    static void ensureAreLoaded(const std::vector<DataField *> &fields,
+                                concurrent::Executor &executor);
+
+    friend class api::File;
+
+    friend class Declarations;
+
+    friend class Parser;
+
+    friend class ParParser;
+
     friend class ParReadTask;
 
+    friend class SeqParser;
+
     friend class SeqReadTask;
 
     friend class Writer;
@@ -0,0 +1,182 @@
+//
+// Created on 17.10.26.
+//
+
+#include "Declarations.h"
+#include "DataField.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace ogss;
+using namespace internal;
+
+DataField *Declarations::find(const api::Object *o) const {
+    const uintptr_t address = (uintptr_t)o;
+    while (true) {
+        const uint32_t v = version.load(std::memory_order_acquire);
+        if (v & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        DataField *r = nullptr;
+        if (const Table *const t = table.load(std::memory_order_acquire)) {
+            const size_t n = used.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < n && i < t->capacity; i++) {
+                const Entry &e = t->entries[i];
+                if (e.begin.load(std::memory_order_relaxed) <= address &&
+                    address < e.end.load(std::memory_order_relaxed)) {
+                    r = e.field.load(std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+
+        // entries read during a change may be inconsistent
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version.load(std::memory_order_relaxed) == v)
+            return r;
+    }
+}
+
+void Declarations::load(const api::Object *o) const {
+    if (DataField *const f = find(o))
+        f->ensureIsLoaded();
+}
+
+void Declarations::record(const api::Object *o) const {
+    if (DataField *const f = find(o)) {
+        f->ensureIsLoaded();
+        f->markChanged(o);
+    }
+}
+
+void Declarations::beginChange() {
+    version.store(version.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void Declarations::endChange() {
+    version.store(version.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_release);
+}
+
+void Declarations::add(DataField *f) {
+    // the instances of the owner and its sub pools
+    std::vector<std::pair<const void *, const void *>> ranges;
+    const AbstractPool *p = f->owner;
+    const auto endTHH = p->THH;
+    do {
+        const auto r = p->instancesRead();
+        if (r.first != r.second)
+            ranges.push_back(r);
+        p = p->next;
+    } while (p && endTHH < p->THH);
+
+    if (ranges.empty())
+        return;
+
+    std::lock_guard<std::mutex> l(lock);
+    const size_t n = used.load(std::memory_order_relaxed);
+    Table *t = table.load(std::memory_order_relaxed);
+
+    // grow before the change, so that lookups do not wait for allocations
+    Table *grown = nullptr;
+    if (!t || t->capacity < n + ranges.size()) {
+        const size_t capacity = std::max(2 * (t ? t->capacity : 4),
+                                         n + ranges.size());
+        grown = new Table{t, capacity, new Entry[capacity]};
+        for (size_t i = 0; i < n; i++) {
+            Entry &e = grown->entries[i];
+            e.begin.store(t->entries[i].begin.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+            e.end.store(t->entries[i].end.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+            e.field.store(t->entries[i].field.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+            e.deferred = t->entries[i].deferred;
+        }
+        t = grown;
+    }
+
+    const bool d = !f->isLoaded();
+    beginChange();
+    if (grown)
+        table.store(grown, std::memory_order_relaxed);
+    for (size_t i = 0; i < ranges.size(); i++) {
+        Entry &e = t->entries[n + i];
+        e.begin.store((uintptr_t)ranges[i].first, std::memory_order_relaxed);
+        e.end.store((uintptr_t)ranges[i].second, std::memory_order_relaxed);
+        e.field.store(f, std::memory_order_relaxed);
+        e.deferred = d;
+    }
+    used.store(n + ranges.size(), std::memory_order_relaxed);
+    if (d)
+        deferred.fetch_add(ranges.size(), std::memory_order_relaxed);
+    endChange();
+}
+
+void Declarations::remove(DataField *f) {
+    std::lock_guard<std::mutex> l(lock);
+    erase(f);
+}
+
+void Declarations::erase(DataField *f) {
+    Table *const t = table.load(std::memory_order_relaxed);
+    if (!t)
+        return;
+
+    size_t n = used.load(std::memory_order_relaxed);
+    size_t i = 0;
+    while (i < n && f != t->entries[i].field.load(std::memory_order_relaxed))
+        i++;
+    if (i == n)
+        return;
+
+    beginChange();
+    while (i < n) {
+        Entry &e = t->entries[i];
+        if (f != e.field.load(std::memory_order_relaxed)) {
+            i++;
+            continue;
+        }
+
+        if (e.deferred)
+            deferred.fetch_sub(1, std::memory_order_release);
+
+        // replace e by the last entry
+        Entry &last = t->entries[--n];
+        e.begin.store(last.begin.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+        e.end.store(last.end.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+        e.field.store(last.field.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+        e.deferred = last.deferred;
+    }
+    used.store(n, std::memory_order_release);
+    endChange();
+}
+
+void Declarations::loaded(DataField *f) {
+    std::lock_guard<std::mutex> l(lock);
+    if (f->sources.empty()) {
+        erase(f);
+        return;
+    }
+
+    // setters still record changes of blocks copied from f
+    Table *const t = table.load(std::memory_order_relaxed);
+    const size_t n = used.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; i++) {
+        Entry &e = t->entries[i];
+        if (e.deferred && f == e.field.load(std::memory_order_relaxed)) {
+            e.deferred = false;
+            deferred.fetch_sub(1, std::memory_order_release);
+        }
+    }
+}
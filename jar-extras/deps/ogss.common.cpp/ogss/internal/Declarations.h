@@ -0,0 +1,123 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_INTERNAL_DECLARATIONS_H
+#define OGSS_COMMON_INTERNAL_DECLARATIONS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace ogss {
+namespace api {
+class Object;
+}
+namespace internal {
+class DataField;
+
+/**
+ * The declarations of a known field in the files of a process. Generated
+ * accessors use them to find the declaration of the file of an object, i.e.
+ * to load the field in that file only and to record changes of blocks that
+ * would be copied from that file.
+ *
+ * A declaration is found by the memory of the instances read from its file.
+ * Objects created later are not found, because no block holds their data.
+ *
+ * @note lookups neither block nor write shared memory
+ */
+class Declarations final {
+    //! the instances of a pool read from file as [begin; end[
+    struct Entry {
+        std::atomic<uintptr_t> begin;
+        std::atomic<uintptr_t> end;
+        std::atomic<DataField *> field;
+
+        //! true, iff field has not been loaded; protected by lock
+        bool deferred;
+    };
+
+    //! entries are never freed, because lookups may still read a table that
+    //! has been replaced by a larger one
+    struct Table {
+        Table *const replaced;
+        const size_t capacity;
+        Entry *const entries;
+    };
+
+    //! protects changes of entries
+    std::mutex lock;
+
+    //! odd, while entries are changed
+    std::atomic<uint32_t> version;
+
+    std::atomic<Table *> table;
+
+    //! the number of entries in table
+    std::atomic<size_t> used;
+
+    //! the number of entries of fields that have not been loaded
+    std::atomic<size_t> deferred;
+
+    //! @return the declaration of the file of o; nullptr, if there is none
+    DataField *find(const api::Object *o) const;
+
+    void load(const api::Object *o) const;
+
+    void record(const api::Object *o) const;
+
+    //! @pre lock is held
+    void erase(DataField *f);
+
+    //! @pre lock is held
+    void beginChange();
+
+    //! @pre lock is held
+    void endChange();
+
+  public:
+    constexpr Declarations() :
+      lock(), version(0), table(nullptr), used(0), deferred(0) {}
+
+    Declarations(const Declarations &) = delete;
+
+    Declarations &operator=(const Declarations &) = delete;
+
+    /**
+     * Register f by the instances read from its file, i.e. by the instances
+     * of its owner and of its sub pools.
+     */
+    void add(DataField *f);
+
+    //! @note no-op, if f has not been added
+    void remove(DataField *f);
+
+    //! f has been loaded; it is removed, unless blocks are copied from it
+    void loaded(DataField *f);
+
+    /**
+     * Ensure that the field has been loaded in the file of o.
+     * @throws Exception as DataField::ensureIsLoaded
+     */
+    inline void ensureIsLoaded(const api::Object *o) const {
+        // fields loaded by other threads have been written before
+        if (deferred.load(std::memory_order_acquire))
+            load(o);
+    }
+
+    /**
+     * Ensure that the field has been loaded in the file of o and record a
+     * change of o in that file.
+     * @throws Exception as DataField::ensureIsLoaded
+     */
+    inline void change(const api::Object *o) const {
+        if (used.load(std::memory_order_acquire))
+            record(o);
+    }
+};
+} // namespace internal
+} // namespace ogss
+
+#endif // OGSS_COMMON_INTERNAL_DECLARATIONS_H
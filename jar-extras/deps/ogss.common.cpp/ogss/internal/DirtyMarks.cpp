@@ -0,0 +1,9 @@
+//
+// Created on 17.10.26.
+//
+
+#include "DirtyMarks.h"
+
+using namespace ogss::internal;
+
+std::atomic<uint32_t> DirtyMarks::epoch(0);
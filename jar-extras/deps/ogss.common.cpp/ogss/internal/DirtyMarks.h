@@ -0,0 +1,80 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_INTERNAL_DIRTYMARKS_H
+#define OGSS_COMMON_INTERNAL_DIRTYMARKS_H
+
+#include "../common.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ogss {
+namespace internal {
+
+/**
+ * Records changes of a field per range of FD_Threshold instances of its owner.
+ * Instances are identified by their index in the owner, because the IDs of
+ * other pools shift on write. A change stores the current epoch in the mark of
+ * its range. Hence, a block read in an epoch is unchanged, iff all marks of its
+ * indices are older.
+ */
+class DirtyMarks final {
+  public:
+    //! number of ranges; indices beyond the last range share its mark
+    static constexpr size_t RANGES = 64;
+
+  private:
+    std::atomic<uint32_t> marks[RANGES];
+
+    //! the current epoch
+    static std::atomic<uint32_t> epoch;
+
+    static size_t range(ObjectID index) noexcept {
+        const size_t r = (size_t)index / ogss::FD_Threshold;
+        return r < RANGES ? r : RANGES - 1;
+    }
+
+  public:
+    DirtyMarks() noexcept {
+        for (auto &m : marks)
+            m.store(0, std::memory_order_relaxed);
+    }
+
+    DirtyMarks(const DirtyMarks &) = delete;
+
+    DirtyMarks &operator=(const DirtyMarks &) = delete;
+
+    //! record a change of the instance with the given index in the owner
+    void mark(ObjectID index) noexcept {
+        // avoid writing shared cache lines on repeated changes
+        std::atomic<uint32_t> &m = marks[range(index)];
+        const uint32_t now = epoch.load(std::memory_order_relaxed);
+        if (m.load(std::memory_order_relaxed) != now)
+            m.store(now, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return true, iff an instance with an index in [first; last] may have
+     * been changed in since or a later epoch
+     */
+    bool changed(ObjectID first, ObjectID last, uint32_t since) const noexcept {
+        for (size_t r = range(first), e = range(last); r <= e; r++)
+            if (marks[r].load(std::memory_order_relaxed) >= since)
+                return true;
+        return false;
+    }
+
+    /**
+     * Start a new epoch, i.e. changes made after the call are newer than
+     * changes made before.
+     * @return the new epoch
+     */
+    static uint32_t advance() noexcept { return epoch.fetch_add(1) + 1; }
+};
+} // namespace internal
+} // namespace ogss
+
+#endif // OGSS_COMMON_INTERNAL_DIRTYMARKS_H
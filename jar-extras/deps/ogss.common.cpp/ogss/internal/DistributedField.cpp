@@ -28,12 +28,15 @@ api::Box DistributedField::getR(const api::Object *i) {
 
 void DistributedField::setR(api::Object *i, api::Box v) {
     ObjectID ID = i->id;
-    if (ID < 0)
+    if (ID < 0) {
         newData[i] = v;
+        return;
+    }
 
     if (0 == ID || ID >= lastID)
         throw std::out_of_range("illegal access to distributed field");
     data[ID - firstID] = v;
+    markChanged(i);
 }
 
 bool DistributedField::check() const {
@@ -61,50 +64,10 @@ static std::mutex dataLock;
 
 void DistributedField::read(int begin, const int end,
                             streams::MappedInStream &in) const {
-    const auto high = end - firstID;
-    auto i = begin - firstID;
-    while (i != high) {
-        data[++i] = type->r(in);
-    }
+    type->rs(in, data + (begin - firstID) + 1, end - begin);
 }
 
 bool DistributedField::write(int begin, const int end,
                              streams::BufferedOutStream *out) const {
-    bool drop = true;
-    const auto high = end - firstID;
-    auto i = begin - firstID;
-    while (i != high) {
-        drop &= type->w(data[++i], out);
-    }
-    return drop;
-}
-
-/**
- * @note this method is invoked _before_ object IDs get reassigned!
- */
-void DistributedField::compress(const ObjectID newLBPO) const {
-    // create new data
-    api::Box *const d = (api::Box *)calloc(owner->cachedSize, sizeof(api::Box));
-
-    // calculate new data
-    // note: data could be null
-    ObjectID next = 0;
-
-    auto is = owner->allObjects();
-    while (is->hasNext()) {
-        const ::ogss::api::Object *const i = is->next();
-        const ObjectID ID = i->id;
-        if (0 != ID) {
-            d[next++] = ID < 0 ? newData[i] : data[ID - firstID];
-        }
-    }
-
-    // update state
-    free(data);
-    data = d;
-    firstID = newLBPO + 1;
-    lastID = firstID + owner->cachedSize;
-    assert(next == owner->cachedSize);
-
-    newData.clear();
+    return type->ws(data + (begin - firstID) + 1, end - begin, out);
 }
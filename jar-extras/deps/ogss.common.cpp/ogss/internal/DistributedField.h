@@ -46,11 +46,11 @@ class DistributedField : public DataField {
 
     void read(int i, int last, streams::MappedInStream &in) const override;
 
-    void compress(ObjectID newLBPO) const;
-
-    bool write(int i, int last, streams::BufferedOutStream *out) const final;
+    bool write(int i, int last, streams::BufferedOutStream *out) const override;
 
     bool check() const override;
+
+    friend class Writer;
 };
 } // namespace internal
 } // namespace ogss
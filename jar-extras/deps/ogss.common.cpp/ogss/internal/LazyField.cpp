@@ -3,9 +3,13 @@
 //
 
 #include "LazyField.h"
+#include "../streams/BufferedOutStream.h"
 #include "AbstractPool.h"
 #include "EnumPool.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 using namespace ogss;
 using namespace internal;
 
@@ -29,8 +33,10 @@ api::Box LazyField::getR(const api::Object *i) {
 
 void LazyField::setR(api::Object *i, api::Box v) {
     ObjectID ID = i->id;
-    if (ID < 0)
+    if (ID < 0) {
         newData[i] = v;
+        return;
+    }
 
     if (0 == ID || ID >= lastID)
         throw std::out_of_range("illegal access to lazy field");
@@ -38,44 +44,66 @@ void LazyField::setR(api::Object *i, api::Box v) {
     ensureIsLoaded();
 
     data[ID - firstID] = v;
+    markChanged(i);
 }
 
-void LazyField::load() {
-    for (Chunk &c : *chunks) {
-        DistributedField::read(c.begin, c.end, *c.in);
+void LazyField::readChunk(const Chunk &c) {
+    const int base = firstID - 1;
+    c.in->willNeed();
+    DistributedField::read(base + c.begin, base + c.end, *c.in);
 
-        if (!c.in->eof())
-            throw std::out_of_range("lazy read task did not consume InStream");
-
-        delete c.in;
-    }
+    if (!c.in->consumed())
+        throw std::out_of_range("lazy read task did not consume InStream");
+    c.in->dontNeed();
+}
 
-    delete chunks;
-    chunks = nullptr;
+void LazyField::read(int i, int last, ogss::streams::MappedInStream &in) const {
+    const int base = firstID - 1;
+    defer(i - base, last - base, &in);
 }
 
-//! global lock used to synchronize deferred reads
-static std::mutex readLock;
+bool LazyField::canCopyBlocks() const {
+    if (isLoaded())
+        return false;
 
-void LazyField::read(int i, int last, ogss::streams::MappedInStream &in) const {
-    std::lock_guard<std::mutex> m(readLock);
+    // IDs of objects, strings and containers are reassigned on write
+    if (type->typeID > KnownTypeID::F64)
+        return false;
+
+    if (owner->modified())
+        return false;
 
-    if (!chunks) {
-        chunks = new std::vector<Chunk>;
+    // the blocks we write must be the blocks we have read
+    const int count = owner->size();
+    for (const Chunk &c : *chunks.load(std::memory_order_relaxed)) {
+        if (c.begin % ogss::FD_Threshold ||
+            c.end != std::min(count, c.begin + ogss::FD_Threshold))
+            return false;
     }
-    chunks->emplace_back(Chunk{i, last, &in});
+    return true;
+}
+
+bool LazyField::write(int i, int last, streams::BufferedOutStream *out) const {
+    if (isLoaded())
+        return DistributedField::write(i, last, out);
+
+    const int base = firstID - 1;
+    for (const Chunk &c : *chunks.load(std::memory_order_relaxed)) {
+        if (c.begin == i - base) {
+            // large blocks are referenced rather than copied
+            const auto bytes = c.in->remaining();
+            c.in->willNeed();
+            out->put(bytes.first, bytes.second);
+            return false;
+        }
+    }
+
+    // the block has not been written to the file we read, i.e. it holds
+    // default values only
+    return true;
 }
 
 bool LazyField::check() const {
     const_cast<LazyField *>(this)->ensureIsLoaded();
     return DistributedField::check();
 }
-
-LazyField::~LazyField() {
-    if (chunks) {
-        for (Chunk &c : *chunks) {
-            delete c.in;
-        }
-        delete chunks;
-    }
-}
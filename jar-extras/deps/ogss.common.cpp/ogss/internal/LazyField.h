@@ -11,32 +11,30 @@
 namespace ogss {
 namespace internal {
 class LazyField : public DistributedField {
-    struct Chunk {
-        int begin;
-        int end;
-        streams::MappedInStream *in;
-    };
-    mutable std::vector<Chunk> *chunks;
-
-    inline bool isLoaded() { return nullptr == chunks; }
-
-    void load();
+    //! decode the block of c into the data of this field
+    void readChunk(const Chunk &c) final;
 
   public:
     LazyField(FieldType *const type, api::String name, TypeID index,
               AbstractPool *const owner) :
-      DistributedField(type, name, index, owner),
-      chunks(nullptr) {}
+      DistributedField(type, name, index, owner) {}
 
-    ~LazyField() override;
-
-    inline void ensureIsLoaded() {
-        if (!isLoaded())
-            load();
-    }
+    /**
+     * @return true, iff the field has not been loaded and its blocks can be
+     * written by copying their encoded bytes, i.e. iff its values contain no
+     * IDs and the layout of its owner does not change on write
+     */
+    bool canCopyBlocks() const;
 
     void read(int i, int last, streams::MappedInStream &in) const override;
 
+    /**
+     * Writes the encoded bytes of the block read from file, if the field has
+     * not been loaded.
+     * @pre canCopyBlocks() held when the write started
+     */
+    bool write(int i, int last, streams::BufferedOutStream *out) const final;
+
     virtual api::Box getR(const api::Object *i) override;
 
     virtual void setR(api::Object *i, api::Box v) override;
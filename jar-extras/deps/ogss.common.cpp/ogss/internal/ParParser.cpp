@@ -4,8 +4,11 @@
 
 #include "ParParser.h"
 #include "../fieldTypes/ContainerType.h"
+#include "../fieldTypes/MapType.h"
+#include "../fieldTypes/SingleArgumentType.h"
 #include "LazyField.h"
 
+#include <algorithm>
 #include <future>
 
 using namespace ogss::internal;
@@ -15,27 +18,29 @@ using ogss::concurrent::Semaphore;
 
 namespace ogss::internal {
 
-// TODO error reporting in tasks will currently not work as intended!
-
-class ParReadTask final : public Job {
+class ParReadTask final : public ParParser::Dependent {
 
     const BlockID block;
     DataField *const f;
     streams::MappedInStream *const in;
-    Semaphore *const barrier;
+    ParParser *const self;
 
   public:
     ParReadTask(DataField *f, BlockID block, streams::MappedInStream *in,
-                Semaphore *barrier) :
-      block(block), f(f), in(in), barrier(barrier) {}
-
-    ~ParReadTask() final {
-        if (!dynamic_cast<LazyField *>(f))
-            delete in;
-    }
+                ParParser *self) :
+      block(block), f(f), in(in), self(self) {}
 
     void run() final {
-        Semaphore::ScopedPermit release(barrier);
+        Semaphore::ScopedPermit release(&self->barrier);
+
+        // lazy fields keep their stream until they are loaded; other streams
+        // are deleted before the parser can be destroyed
+        const bool lazy = dynamic_cast<LazyField *>(f);
+        std::unique_ptr<streams::MappedInStream> owned(lazy ? nullptr : in);
+
+        if (self->cancelled.load())
+            return;
+        self->prefetchNext();
 
         AbstractPool *const owner = f->owner;
         const int bpo = owner->bpo;
@@ -43,34 +48,61 @@ class ParReadTask final : public Job {
         const int last =
           std::min(owner->cachedSize, first + ogss::FD_Threshold);
 
-        f->read(bpo + first, bpo + last, *in);
+        try {
+            if (lazy) {
+                f->read(bpo + first, bpo + last, *in);
+                return;
+            }
+
+            in->willNeed();
+            f->read(bpo + first, bpo + last, *in);
 
-        if (!in->eof() && !(dynamic_cast<LazyField *>(f)))
-            throw std::out_of_range("read task did not consume InStream");
+            if (!in->consumed())
+                throw std::out_of_range("read task did not consume InStream");
+            in->dontNeed();
+        } catch (std::exception &e) {
+            self->fail(e.what());
+        } catch (...) {
+            self->fail("read task non-standard crash");
+        }
     }
 };
 
-class PHRT final : public Job {
+class PHRT final : public ParParser::Dependent {
 
     const BlockID block;
     fieldTypes::ContainerType *const t;
     streams::MappedInStream *const in;
-    Semaphore *const barrier;
+    ParParser *const self;
 
   public:
     PHRT(fieldTypes::ContainerType *t, int block, streams::MappedInStream *in,
-         Semaphore *barrier) :
-      block(block), t(t), in(in), barrier(barrier) {}
-
-    ~PHRT() final { delete in; }
+         ParParser *self) :
+      block(block), t(t), in(in), self(self) {}
 
     void run() override {
-        Semaphore::ScopedPermit release(barrier);
+        Semaphore::ScopedPermit release(&self->barrier);
+        std::unique_ptr<streams::MappedInStream> owned(in);
+        if (self->cancelled.load())
+            return;
+        self->prefetchNext();
 
         ObjectID i = block * ogss::HD_Threshold;
         const ObjectID end =
           std::min((ObjectID)t->idMap.size() - 1, i + ogss::HD_Threshold);
-        t->read(i, end, in);
+        try {
+            in->willNeed();
+            t->read(i, end, in);
+
+            if (!in->consumed())
+                throw std::out_of_range(
+                  "hull read task did not consume InStream");
+            in->dontNeed();
+        } catch (std::exception &e) {
+            self->fail(e.what());
+        } catch (...) {
+            self->fail("hull read task non-standard crash");
+        }
     }
 };
 } // namespace ogss
@@ -79,29 +111,48 @@ ParParser::ParParser(const std::string &path, streams::FileInputStream *in,
                      const PoolBuilder &pb) :
   Parser(path, in, pb),
   barrier(),
-  jobs(),
-  jobMX(),
-  threadPool(new concurrent::Pool()) {}
+  awaited(0),
+  allocations(),
+  scanned(false),
+  cancelled(false),
+  errorLock(),
+  errors(),
+#ifndef _WIN32
+  io(),
+#endif
+  prefetchLock(),
+  upcoming(),
+  prefetched(0) {}
 
 ParParser::~ParParser() noexcept(false) {
-    barrier.takeMany(jobs.size());
+    // tasks waiting for hulls of a broken file are started, but do not read
+    if (!scanned) {
+        cancelled.store(true);
+        endScan();
+    }
+
+    // jobs do not touch this parser after releasing their permit
+    barrier.takeMany(awaited);
 
-    if (threadPool->hasErrors()) {
+    if (!errors.empty()) {
         // error propagation code, i.e. aggregate error messages
-        std::vector<std::string> errors;
-        threadPool->takeErrors(errors);
         std::stringstream ss;
         ss << "read jobs had errors:" << std::endl;
         for (auto &e : errors) {
             ss << "  " << e << std::endl;
         }
 
-        delete threadPool;
-
         throw ogss::Exception(ss.str());
     }
+}
 
-    delete threadPool;
+void ParParser::fail(const std::string &message) {
+    {
+        std::lock_guard<std::mutex> lock(errorLock);
+        errors.push_back(message);
+    }
+    // the file is broken; remaining tasks must not rely on its contents
+    cancelled.store(true);
 }
 
 /**
@@ -141,11 +192,38 @@ void ParParser::typeBlock() {
                 AbstractPool *p = classes[i];
                 p->allocateData();
                 p->lastID = p->bpo + p->cachedSize;
-                if (0 != p->staticDataInstances) {
-                    threadPool->run(new AllocateInstances(p, &barrier));
-                } else {
-                    // we would not allocate an instance anyway
-                    barrier.release();
+
+                // we would not allocate an instance of an empty pool anyway
+                const ObjectID count = p->staticDataInstances;
+                if (!count) {
+                    allocations[p].reset(new Allocation(0));
+                    continue;
+                }
+                p->allocateBook();
+
+                // instances are created on the nodes that will read them;
+                // ranges are relative to p
+                const size_t size = p->base->cachedSize;
+                std::vector<std::pair<size_t, ObjectID>> ranges;
+                for (size_t n = 0; n < executor->nodes(); n++) {
+                    const ObjectID begin = std::max<ObjectID>(
+                      0, (ObjectID)executor->nodeBegin(n, size) - p->bpo);
+                    const ObjectID end = std::min<ObjectID>(
+                      count,
+                      (ObjectID)executor->nodeBegin(n + 1, size) - p->bpo);
+                    if (begin < end)
+                        ranges.emplace_back(n, begin);
+                }
+
+                Allocation *const a = new Allocation(ranges.size());
+                allocations[p].reset(a);
+                for (size_t r = 0; r < ranges.size(); r++) {
+                    const ObjectID end =
+                      r + 1 < ranges.size() ? ranges[r + 1].second : count;
+                    awaited++;
+                    executor->runOn(ranges[r].first,
+                                    new AllocateInstances(p, ranges[r].second,
+                                                          end, a, this));
                 }
             }
         }
@@ -174,10 +252,20 @@ void ParParser::typeBlock() {
  */
 void ParParser::processData() {
 
-    // we expect one HD-entry per field
-    jobs.reserve(fields.size());
+    // hulls are allocated by HD blocks; they are complete once all blocks
+    // have been found
+    allocations[strings].reset(new Allocation(1));
+    for (HullType *c : containers)
+        allocations[c].reset(new Allocation(1));
+
+    std::vector<Allocation *> deps;
 
-    int awaitHulls = 0;
+#ifndef _WIN32
+    // pages of smaller files are populated on open
+    if (!in->streamed() &&
+        in->size() > streams::FileInputStream::POPULATE_LIMIT)
+        io.reset(streams::IOBackend::open());
+#endif
 
     while (!in->eof()) {
         // create the map directly and use it for subsequent read-operations to
@@ -192,26 +280,58 @@ void ParParser::processData() {
         if (auto p = dynamic_cast<HullType *>(f)) {
             const int count = map->v32();
 
-            // start hull allocation job
-            awaitHulls++;
-            threadPool->run(new AllocateHull(p, count, map, this));
+            // start hull allocation job; it will create a read task for
+            // containers
+            Allocation *const a = allocations.at(p).get();
+            a->pending++;
+            awaited += dynamic_cast<fieldTypes::ContainerType *>(p) ? 2 : 1;
+            expect(map);
+            executor->run(new AllocateHull(p, count, map, a, this));
 
         } else if (auto fd = dynamic_cast<DataField *>(f)) {
             BlockID block =
               fd->owner->cachedSize > ogss::FD_Threshold ? map->v32() : 0;
+            keepSource(fd, block, map);
+
+            // fields outside the projection keep their blocks; their pages
+            // are neither requested nor read
+            if (deferred(fd)) {
+                defer(fd, block, map);
+                continue;
+            }
+
+            // lazy fields do not read until they are loaded; distributed
+            // fields do not read into instances of their owner
+            deps.clear();
+            if (!dynamic_cast<LazyField *>(fd)) {
+                if (!dynamic_cast<DistributedField *>(fd))
+                    requirements(fd->owner, deps);
+                requirements(fd->type, deps);
+            }
 
             // create job with adjusted size that corresponds to the * in the
             // specification (i.e. exactly the data)
-            std::lock_guard<std::mutex> lock(jobMX);
-            jobs.push_back(new ParReadTask(fd, block, map, &barrier));
+            ParReadTask *const task = new ParReadTask(fd, block, map, this);
+
+            // data is decoded on the node that allocated the instances of
+            // the block; lazy fields are decoded when they are loaded
+            if (!dynamic_cast<LazyField *>(fd))
+                task->node =
+                  nodeOf(fd->owner->base,
+                         fd->owner->bpo + block * ogss::FD_Threshold);
+
+            awaited++;
+            expect(map);
+            schedule(task, deps);
         }
     }
 
-    // await allocations of class and hull types
-    barrier.takeMany(classes.size() + awaitHulls);
+    // request blocks ahead of the started tasks; each read task requests one
+    // more once it starts
+    for (size_t i = 0; i < PREFETCH_WINDOW; i++)
+        prefetchNext();
 
-    // start read tasks
-    threadPool->runAll(jobs);
+    endScan();
 
     // TODO start tasks that perform default initialization of fields not
     // obtained from file
@@ -219,12 +339,130 @@ void ParParser::processData() {
 
 void ParParser::AllocateHull::run() {
     concurrent::Semaphore::ScopedPermit release(&self->barrier);
-    int block = p->allocateInstances(count, map);
+    ScopedAllocation done(self, a);
+    int block;
+    try {
+        block = p->allocateInstances(count, map);
+    } catch (std::exception &e) {
+        self->fail(e.what());
+        block = -1;
+    } catch (...) {
+        self->fail("hull allocation non-standard crash");
+        block = -1;
+    }
 
     // create hull read data task except for StringPool which is still lazy per
     // element and eager per offset
     if (const auto ct = dynamic_cast<fieldTypes::ContainerType *>(p)) {
-        std::lock_guard<std::mutex> lock(self->jobMX);
-        self->jobs.push_back(new PHRT(ct, block, map, &self->barrier));
+        // the task reads into all blocks of the hull
+        std::vector<Allocation *> deps(1, a);
+        if (auto s = dynamic_cast<fieldTypes::SingleArgumentType *>(ct)) {
+            self->requirements(s->base, deps);
+        } else {
+            auto m = (fieldTypes::MapType<api::Box, api::Box> *)ct;
+            self->requirements(m->keyType, deps);
+            self->requirements(m->valueType, deps);
+        }
+        self->schedule(new PHRT(ct, block, map, self), deps);
+    }
+}
+
+void ParParser::requirements(const fieldTypes::FieldType *t,
+                             std::vector<Allocation *> &deps) const {
+    if (t->typeID < KnownTypeID::ANY_REF)
+        return;
+
+    // any reference can point to any instance
+    if (KnownTypeID::ANY_REF == t->typeID) {
+        for (auto &a : allocations)
+            deps.push_back(a.second.get());
+        return;
+    }
+
+    // references point into the type hierarchy below t
+    if (auto p = dynamic_cast<const AbstractPool *>(t)) {
+        const auto endTHH = p->THH;
+        do {
+            auto a = allocations.find(p);
+            if (a != allocations.end())
+                deps.push_back(a->second.get());
+            p = p->next;
+        } while (p && endTHH < p->THH);
+        return;
+    }
+
+    // enums are not allocated
+    auto a = allocations.find(t);
+    if (a != allocations.end())
+        deps.push_back(a->second.get());
+}
+
+void ParParser::schedule(Dependent *task, std::vector<Allocation *> &deps) {
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+
+    for (Allocation *a : deps) {
+        std::lock_guard<std::mutex> lock(a->mx);
+        if (!a->done) {
+            task->blockers++;
+            a->waiting.push_back(task);
+        }
+    }
+    unblock(task);
+}
+
+void ParParser::unblock(Dependent *task) {
+    if (1 == task->blockers.fetch_sub(1))
+        executor->runOn(task->node, task);
+}
+
+size_t ParParser::nodeOf(const AbstractPool *base, ObjectID index) const {
+    return executor->nodeOf(index, base->cachedSize);
+}
+
+void ParParser::finished(Allocation *a) {
+    if (1 != a->pending.fetch_sub(1))
+        return;
+
+    std::vector<Dependent *> ready;
+    {
+        std::lock_guard<std::mutex> lock(a->mx);
+        a->done = true;
+        ready.swap(a->waiting);
+    }
+    for (Dependent *task : ready)
+        unblock(task);
+}
+
+void ParParser::endScan() {
+    scanned = true;
+    for (auto &a : allocations)
+        if (dynamic_cast<const HullType *>(a.first))
+            finished(a.second.get());
+}
+
+void ParParser::expect(const streams::MappedInStream *map) {
+#ifndef _WIN32
+    if (io) {
+        std::lock_guard<std::mutex> l(prefetchLock);
+        upcoming.push_back(map->neededPages());
+    }
+#endif
+}
+
+void ParParser::prefetchNext() {
+#ifndef _WIN32
+    if (!io)
+        return;
+
+    std::pair<const void *, size_t> pages;
+    {
+        std::lock_guard<std::mutex> l(prefetchLock);
+        if (prefetched == upcoming.size())
+            return;
+        pages = upcoming[prefetched++];
     }
+    if (pages.second)
+        io->willNeed(pages.first, pages.second);
+#endif
 }
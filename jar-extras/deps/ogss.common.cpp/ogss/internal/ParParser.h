@@ -5,10 +5,17 @@
 #ifndef OGSS_TEST_CPP_PARPARSER_H
 #define OGSS_TEST_CPP_PARPARSER_H
 
-#include "../concurrent/Pool.h"
+#include "../concurrent/Executor.h"
 #include "../concurrent/Semaphore.h"
+#include "../streams/IOBackend.h"
 #include "Parser.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 namespace ogss {
 namespace internal {
 
@@ -20,16 +27,118 @@ namespace internal {
 class ParParser final : public Parser {
     concurrent::Semaphore barrier;
 
-    // jobs is a field as we need it for await
-    std::vector<concurrent::Job *> jobs;
-    // protection for jobs until we implement a wait-free queue
-    std::mutex jobMX;
+    //! number of permits of barrier released by started jobs
+    int32_t awaited;
+
+    /**
+     * A read task. It is started once all allocations it depends on have
+     * finished.
+     */
+    struct Dependent : public concurrent::Job {
+        //! unfinished allocations; one more while dependencies are added
+        std::atomic<int32_t> blockers;
+
+        //! the node of the executor the task is placed on
+        size_t node;
+
+        Dependent() : blockers(1), node(concurrent::Executor::ANY_NODE) {}
+    };
+
+    /**
+     * The allocation of the instances of a pool or hull.
+     */
+    struct Allocation {
+        //! number of allocation jobs that have not finished
+        std::atomic<int32_t> pending;
+
+        //! protects the fields below
+        std::mutex mx;
+
+        //! true, iff all allocation jobs have finished
+        bool done;
+
+        //! tasks to be unblocked once done
+        std::vector<Dependent *> waiting;
+
+        explicit Allocation(int32_t pending) :
+          pending(pending), mx(), done(0 == pending), waiting() {}
+    };
+
+    /**
+     * The allocations of pools and hulls. Hulls are allocated by their HD
+     * blocks. Hence, each of their allocations holds an extra pending job until
+     * all blocks have been found.
+     * @note the map is not changed once the first HD block has been found
+     */
+    std::unordered_map<const fieldTypes::FieldType *,
+                       std::unique_ptr<Allocation>>
+      allocations;
+
+    //! true, iff all HD blocks have been found
+    bool scanned;
+
+    //! true, iff read tasks shall not read, because the file is broken
+    std::atomic<bool> cancelled;
+
+    //! protects errors
+    std::mutex errorLock;
+
+    //! errors of jobs; the parser fails, if there is any
+    std::vector<std::string> errors;
+
+    //! report an error of a job; cancels tasks that have not started yet
+    void fail(const std::string &message);
+
+#ifndef _WIN32
+    /**
+     * Prefetches blocks of large mapped files ahead of read tasks. Nullptr, if
+     * the file is populated on open or there is no asynchronous backend.
+     */
+    std::unique_ptr<streams::IOBackend> io;
+#endif
+
+    //! protects upcoming and prefetched; tasks start while blocks are found
+    std::mutex prefetchLock;
+
+    //! the pages of all blocks read in file order; empty, if io is nullptr
+    std::vector<std::pair<const void *, size_t>> upcoming;
+
+    //! the index of the next element of upcoming to be prefetched
+    size_t prefetched;
+
+    //! number of blocks requested ahead of started read tasks
+    static constexpr size_t PREFETCH_WINDOW = 16;
 
     /**
-     * The thread pool used to create this initializer. Nullptr, if not a
-     * ParParser.
+     * append the pages of a block that will be read to upcoming
      */
-    concurrent::Pool *threadPool;
+    void expect(const streams::MappedInStream *map);
+
+    /**
+     * request the next upcoming block; called by each read task once it starts
+     * @note blocks that have not been found yet are requested by the scan
+     */
+    void prefetchNext();
+
+    /**
+     * Add the allocations required to read values of type t to deps.
+     */
+    void requirements(const fieldTypes::FieldType *t,
+                      std::vector<Allocation *> &deps) const;
+
+    /**
+     * Start task once all allocations in deps have finished.
+     */
+    void schedule(Dependent *task, std::vector<Allocation *> &deps);
+
+    //! remove a blocker of task; starts task, if it was the last
+    void unblock(Dependent *task);
+
+    //! mark an allocation job of a as finished
+    void finished(Allocation *a);
+
+    //! mark all hulls as scanned, i.e. allow their allocations to finish
+    void endScan();
 
     ParParser(const std::string &path, streams::FileInputStream *in,
               const PoolBuilder &pb);
@@ -41,17 +150,45 @@ class ParParser final : public Parser {
 
     void processData() final;
 
+    //! finishes an allocation job on destruction, i.e. also if it failed
+    struct ScopedAllocation {
+        ParParser *const self;
+        Allocation *const a;
+
+        ScopedAllocation(ParParser *self, Allocation *a) : self(self), a(a) {}
+
+        ~ScopedAllocation() { self->finished(a); }
+    };
+
+    //! @return the node of the executor that will scan index of base's data
+    size_t nodeOf(const AbstractPool *base, ObjectID index) const;
+
     struct AllocateInstances final : public concurrent::Job {
         AbstractPool *const p;
-        concurrent::Semaphore *const barrier;
+        //! the range of instances of p created by this job
+        const ObjectID begin;
+        const ObjectID end;
+        Allocation *const a;
+        ParParser *const self;
 
-        AllocateInstances(AbstractPool *p, concurrent::Semaphore *barrier) :
+        AllocateInstances(AbstractPool *p, ObjectID begin, ObjectID end,
+                          Allocation *a, ParParser *self) :
           p(p),
-          barrier(barrier) {}
+          begin(begin),
+          end(end),
+          a(a),
+          self(self) {}
 
         void run() final {
-            concurrent::Semaphore::ScopedPermit release(barrier);
-            p->allocateInstances();
+            concurrent::Semaphore::ScopedPermit release(&self->barrier);
+            ScopedAllocation done(self, a);
+            try {
+                p->createInstances(begin, end);
+            } catch (std::exception &e) {
+                self->fail(e.what());
+            } catch (...) {
+                self->fail("allocation non-standard crash");
+            }
         }
     };
 
@@ -59,19 +196,23 @@ class ParParser final : public Parser {
         HullType *const p;
         const int count;
         streams::MappedInStream *const map;
+        Allocation *const a;
         ParParser *const self;
 
         AllocateHull(HullType *p, int count, streams::MappedInStream *map,
-                     ParParser *self) :
+                     Allocation *a, ParParser *self) :
           p(p),
           count(count),
           map(map),
+          a(a),
           self(self) {}
 
         void run() final;
     };
 
     friend struct StateInitializer;
+    friend class ParReadTask;
+    friend class PHRT;
 };
 } // namespace internal
 } // namespace ogss
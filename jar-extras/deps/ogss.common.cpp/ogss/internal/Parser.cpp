@@ -67,7 +67,50 @@ void ogss::internal::Parser::parseFile(FileInputStream *in) {
 
 ogss::internal::Parser::Parser(const std::string &path, FileInputStream *in,
                                const PoolBuilder &pb) :
-  StateInitializer(path, in, pb), pb(pb), fields(), fdts() {}
+  StateInitializer(path, in, pb),
+  pb(pb),
+  fields(),
+  fdts(),
+  epoch(DirtyMarks::advance()) {}
+
+void ogss::internal::Parser::keepSource(DataField *fd, BlockID block,
+                                        const streams::MappedInStream *map) {
+    // streamed blocks are released after reading them
+    if (in->streamed())
+        return;
+
+    // IDs of strings and containers are reassigned on write
+    if (fd->type->typeID > KnownTypeID::F64 &&
+        !dynamic_cast<const AbstractPool *>(fd->type))
+        return;
+
+    if (fd->sources.empty()) {
+        const ObjectID count = fd->owner->cachedSize;
+        fd->sources.resize(count > ogss::FD_Threshold
+                             ? (count - 1) / ogss::FD_Threshold + 1
+                             : 1);
+        fd->sourceEpoch = epoch;
+    }
+
+    if ((size_t)block < fd->sources.size())
+        fd->sources[block] = map->remaining();
+}
+
+bool ogss::internal::Parser::deferred(const DataField *fd) const {
+    return projection && !dynamic_cast<const LazyField *>(fd) &&
+           !projection->contains(fd->owner->name, fd->name);
+}
+
+void ogss::internal::Parser::defer(DataField *fd, BlockID block,
+                                   streams::MappedInStream *map) {
+    // changes are detected relative to the epoch of the read
+    fd->sourceEpoch = epoch;
+
+    const int first = block * ogss::FD_Threshold;
+    fd->defer(first,
+              std::min(fd->owner->cachedSize, first + ogss::FD_Threshold),
+              map);
+}
 
 void ogss::internal::Parser::ParseException(ogss::InStream *in,
                                             const std::string &msg) {
@@ -52,6 +52,9 @@ class Parser : public StateInitializer {
      */
     std::vector<fieldTypes::FieldType *> fdts;
 
+    //! the epoch in which the file is read
+    const uint32_t epoch;
+
     Parser(const std::string &path, streams::FileInputStream *in,
            const PoolBuilder &pb);
 
@@ -77,6 +80,24 @@ class Parser : public StateInitializer {
 
     void readFields(AbstractPool *p);
 
+    /**
+     * Remember the encoded block of fd held by map, so that it can be copied
+     * on write as long as it is not changed.
+     * @pre map has been read up to the data of the block
+     */
+    void keepSource(DataField *fd, BlockID block,
+                    const streams::MappedInStream *map);
+
+    /**
+     * @return true, iff fd is a known field outside the projection, i.e. iff
+     * its blocks are deferred instead of being read
+     * @note lazy fields defer their blocks on read
+     */
+    bool deferred(const DataField *fd) const;
+
+    //! keep the block of fd held by map until fd is loaded
+    void defer(DataField *fd, BlockID block, streams::MappedInStream *map);
+
     virtual void processData() = 0;
 
     friend struct StateInitializer;
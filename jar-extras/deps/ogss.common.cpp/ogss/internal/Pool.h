@@ -65,17 +65,24 @@ template <class T> class Pool : public AbstractPool {
         newObjects.clear();
     }
 
-    void allocateInstances() override {
-        book = new Book<T>(staticDataInstances);
-        T *page = book->firstPage();
-        ObjectID i = bpo;
-        const auto last = i + staticDataInstances;
+    void allocateBook() final { book = new Book<T>(staticDataInstances); }
+
+    void createInstances(ObjectID begin, const ObjectID end) override {
+        T *page = book->firstPage() + begin;
+        ObjectID i = bpo + begin;
+        const auto last = bpo + end;
         while (i < last) {
             data[i] = new (page) T();
             (page++)->id = ++i;
         }
     }
 
+    std::pair<const void *, const void *> instancesRead() const final {
+        // instances read from file are the first page of the book
+        const T *const page = book ? book->initialPage() : nullptr;
+        return {page, page ? page + staticDataInstances : nullptr};
+    }
+
     /**
      * All stored objects, which have exactly the type T. Objects are stored as
      * arrays of field entries. The types of the respective fields can be
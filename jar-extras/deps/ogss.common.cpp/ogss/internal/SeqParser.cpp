@@ -38,10 +38,18 @@ class SeqReadTask final : public Job {
         const int last =
           std::min(owner->cachedSize, first + ogss::FD_Threshold);
 
+        // lazy fields keep their stream until they are loaded
+        if (dynamic_cast<LazyField *>(f)) {
+            f->read(bpo + first, bpo + last, *in);
+            return;
+        }
+
+        in->willNeed();
         f->read(bpo + first, bpo + last, *in);
 
-        if (!in->eof() && !(dynamic_cast<LazyField *>(f)))
+        if (!in->consumed())
             throw std::out_of_range("read task did not consume InStream");
+        in->dontNeed();
     }
 };
 
@@ -61,7 +69,12 @@ class SHRT final : public Job {
         const ObjectID end =
           std::min((ObjectID)t->idMap.size() - 1, i + ogss::HD_Threshold);
 
+        in->willNeed();
         t->read(i, end, in);
+
+        if (!in->consumed())
+            throw std::out_of_range("hull read task did not consume InStream");
+        in->dontNeed();
     }
 };
 } // namespace internal
@@ -162,6 +175,13 @@ void SeqParser::processData() {
         } else if (auto fd = dynamic_cast<DataField *>(f)) {
             BlockID block =
               fd->owner->cachedSize > ogss::FD_Threshold ? map->v32() : 0;
+            keepSource(fd, block, map);
+
+            // fields outside the projection keep their blocks
+            if (deferred(fd)) {
+                defer(fd, block, map);
+                continue;
+            }
 
             // create job with adjusted size that corresponds to the * in the
             // specification (i.e. exactly the data)
@@ -8,6 +8,7 @@
 #include "ParParser.h"
 #include "SeqParser.h"
 
+#include "../concurrent/Pool.h"
 #include "../fieldTypes/AnyRefType.h"
 #include "../fieldTypes/BuiltinFieldType.h"
 #include "../fieldTypes/MapType.h"
@@ -18,20 +19,66 @@ using namespace ogss::internal;
 using namespace ogss::fieldTypes;
 
 StateInitializer *StateInitializer::make(const std::string &path,
-                                         const PoolBuilder &pb, uint8_t mode) {
+                                         const PoolBuilder &pb, uint8_t mode,
+                                         concurrent::Executor *executor,
+                                         const api::Projection *projection) {
+    if (mode & api::ReadMode::create) {
+        std::unique_ptr<StateInitializer> init(new Creator(path, pb));
+        init->canWrite = 0 == (mode & api::WriteMode::readOnly);
+        if (executor)
+            init->executor = executor;
+        return init.release();
+    }
+
+    return make(new FileInputStream(path), pb, mode, executor,
+                projection);
+}
+
+StateInitializer *StateInitializer::make(int fd, const PoolBuilder &pb,
+                                         uint8_t mode,
+                                         concurrent::Executor *executor,
+                                         const api::Projection *projection) {
+    return make(new FileInputStream(fd), pb, mode, executor,
+                projection);
+}
+
+StateInitializer *StateInitializer::make(const void *buffer, size_t size,
+                                         const PoolBuilder &pb, uint8_t mode,
+                                         concurrent::Executor *executor,
+                                         const api::Projection *projection) {
+    return make(new FileInputStream(buffer, size), pb, mode, executor,
+                projection);
+}
+
+StateInitializer *StateInitializer::make(streams::ByteSource *source,
+                                         const PoolBuilder &pb, uint8_t mode,
+                                         concurrent::Executor *executor,
+                                         const api::Projection *projection) {
+    return make(new FileInputStream(source), pb, mode, executor,
+                projection);
+}
+
+StateInitializer *StateInitializer::make(FileInputStream *fs,
+                                         const PoolBuilder &pb, uint8_t mode,
+                                         concurrent::Executor *executor,
+                                         const api::Projection *projection) {
     std::unique_ptr<StateInitializer> init(nullptr);
-    if (mode & api::ReadMode::create)
-        init.reset(new Creator(path, pb));
-    else {
-        const auto fs = new FileInputStream(path);
+    // @note streamed files are parsed in parallel to overlap I/O and decoding
+    if (!fs->streamed() && fs->size() < SEQ_PARSER_LIMIT)
+        init.reset(new SeqParser(fs->getPath(), fs, pb));
+    else
+        init.reset(new ParParser(fs->getPath(), fs, pb));
 
-        if (fs->size() < SEQ_PARSER_LIMIT)
-            init.reset(new SeqParser(path, fs, pb));
-        else
-            init.reset(new ParParser(path, fs, pb));
+    if (executor)
+        init->executor = executor;
+    init->projection = projection;
+
+    // strings of read-only files are not interned unless required
+    if (mode & api::WriteMode::readOnly)
+        init->strings->interning = false;
+
+    ((Parser *)init.get())->parseFile(fs);
 
-        ((Parser *)init.get())->parseFile(fs);
-    }
     init->canWrite = 0 == (mode & api::WriteMode::readOnly);
     return init.release();
 }
@@ -41,6 +88,8 @@ StateInitializer::StateInitializer(const std::string &path, FileInputStream *in,
   path(path),
   in(in),
   canWrite(true),
+  executor(&concurrent::Pool::shared()),
+  projection(nullptr),
   guard(),
   classes(),
   containers(),
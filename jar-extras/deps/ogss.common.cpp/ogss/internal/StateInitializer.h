@@ -6,6 +6,8 @@
 #define OGSS_CPP_STATEINITIALIZER_H
 
 #include "../api/File.h"
+#include "../api/Projection.h"
+#include "../concurrent/Executor.h"
 #include "../streams/FileInputStream.h"
 #include "PoolBuilder.h"
 
@@ -27,13 +29,65 @@ using streams::FileInputStream;
 
 struct StateInitializer {
 
+    /**
+     * read or create a state
+     *
+     * @note jobs of the parser and the resulting state are run by executor;
+     * nullptr selects concurrent::Pool::shared()
+     * @note only fields selected by projection are decoded while reading;
+     * nullptr selects all fields
+     */
     static StateInitializer *make(const std::string &path,
-                                  const PoolBuilder &pb, uint8_t mode);
+                                  const PoolBuilder &pb, uint8_t mode,
+                                  concurrent::Executor *executor = nullptr,
+                                  const api::Projection *projection = nullptr);
+
+    /**
+     * read a state from the file behind a file descriptor
+     *
+     * @note the descriptor remains owned by the caller
+     * @note descriptors that cannot be mapped, e.g. pipes, are read
+     * sequentially
+     * @note the resulting state has no path; it has to be set before flushing
+     */
+    static StateInitializer *make(int fd, const PoolBuilder &pb, uint8_t mode,
+                                  concurrent::Executor *executor = nullptr,
+                                  const api::Projection *projection = nullptr);
+
+    /**
+     * read a state from a buffer in memory without copying it
+     *
+     * @note the buffer remains owned by the caller and must outlive the state
+     * or its loadLazyData
+     * @note the resulting state has no path; it has to be set before flushing
+     */
+    static StateInitializer *make(const void *buffer, size_t size,
+                                  const PoolBuilder &pb, uint8_t mode,
+                                  concurrent::Executor *executor = nullptr,
+                                  const api::Projection *projection = nullptr);
+
+    /**
+     * read a state sequentially from a source that cannot be mapped
+     *
+     * @note takes ownership of source
+     * @note the resulting state has no path; it has to be set before flushing
+     */
+    static StateInitializer *make(streams::ByteSource *source,
+                                  const PoolBuilder &pb, uint8_t mode,
+                                  concurrent::Executor *executor = nullptr,
+                                  const api::Projection *projection = nullptr);
 
     const std::string &path;
     std::unique_ptr<FileInputStream> in;
     bool canWrite;
 
+    //! runs the jobs of the parser and the resulting state; never nullptr
+    concurrent::Executor *executor;
+
+    //! the fields decoded by the parser; nullptr, if all fields are decoded
+    //! @note not used after construction
+    const api::Projection *projection;
+
     // guard from file
     std::unique_ptr<std::string> guard;
 
@@ -57,6 +111,15 @@ struct StateInitializer {
     const size_t sifaSize;
 
   protected:
+    /**
+     * parse in; the read mode is ignored
+     * @note consumes in
+     */
+    static StateInitializer *make(FileInputStream *in, const PoolBuilder &pb,
+                                  uint8_t mode,
+                                  concurrent::Executor *executor,
+                                  const api::Projection *projection);
+
     /**
      * next SIFA ID to be used if some type is added to SIFA
      */
@@ -19,6 +19,9 @@ internal::StringPool::StringPool(const AbstractStringKeeper *sk) :
   literalStrings(sk->strings),
   literalStringCount(sk->size),
   positions(nullptr),
+  slab(nullptr),
+  interning(true),
+  aliases(),
   lastID(0) {
 
     knownStrings.reserve(sk->size);
@@ -32,6 +35,7 @@ internal::StringPool::~StringPool() {
         delete s;
 
     delete[] positions;
+    delete[] slab;
 
     // delete in, as it may still be valid
     delete in;
@@ -41,7 +45,32 @@ internal::StringPool::~StringPool() {
         delete[] literalStrings;
 }
 
+void internal::StringPool::intern() const {
+    if (interning.load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard<std::mutex> readLock(mapLock);
+    if (interning.load(std::memory_order_relaxed))
+        return;
+
+    const ObjectID last = idMap.size();
+    for (ObjectID i = 1; i < last; i++) {
+        // @note objects may refer to a string read before, even if another
+        // string with the same image is known already; hence, such strings
+        // cannot be replaced
+        if (const auto s = static_cast<String>(idMap[i])) {
+            const auto r = knownStrings.insert(s);
+            if (!r.second && *r.first != s)
+                aliases.emplace_back(s, *r.first);
+        }
+    }
+
+    interning.store(true, std::memory_order_release);
+}
+
 void internal::StringPool::loadLazyData() {
+    intern();
+
     if (!in)
         return;
 
@@ -135,6 +164,7 @@ internal::StringPool::allocateInstances(int count,
     int spi = idMap.size();
     const auto sp = new uint64_t[spi + count];
     positions = sp;
+    slab = new std::string[spi + count];
 
     // store offsets
     // @note this has to be done after reading all offsets, as sizes are
@@ -5,8 +5,10 @@
 #ifndef SKILL_CPP_COMMON_STRINGPOOL_H
 #define SKILL_CPP_COMMON_STRINGPOOL_H
 
+#include <atomic>
 #include <set>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "../fieldTypes/HullType.h"
@@ -77,6 +79,31 @@ class StringPool final : public fieldTypes::HullType {
      */
     uint64_t *positions;
 
+    /**
+     * In-place storage of strings read from the file, indexed like positions.
+     * This saves one allocation per string read and, for short strings, the
+     * only one.
+     *
+     * @note entries that have not been read are empty
+     */
+    std::string *slab;
+
+    /**
+     * True, iff strings read from the file are unified with known strings. If
+     * a file is opened read-only, unification is deferred until the first
+     * string is added or the file becomes writable.
+     * @note set under mapLock
+     */
+    mutable std::atomic<bool> interning;
+
+    /**
+     * Strings read before interning that equal a known string, i.e. a literal,
+     * and the known string. Objects may still refer to them; hence, they are
+     * written with the ID of the known string.
+     */
+    mutable std::vector<std::pair<ogss::api::String, ogss::api::String>>
+      aliases;
+
     /**
      * next legal ID, used to check access
      */
@@ -94,6 +121,8 @@ class StringPool final : public fieldTypes::HullType {
      * @note the resulting string object is owned by this pool
      */
     ogss::api::String add(const char *img) const {
+        intern();
+
         auto r = new std::string(img);
         auto other = knownStrings.find(r);
         if (other != knownStrings.end()) {
@@ -127,21 +156,25 @@ class StringPool final : public fieldTypes::HullType {
                 std::lock_guard<std::mutex> readLock(mapLock);
 
                 // read result
-                uint64_t off = positions[index];
-                result = in->string(off >> 32LU, (uint32_t)off);
+                const api::StringView v = view(index);
+                std::string &str = slab[index];
+                str.assign(v.data, v.size);
+                result = &str;
 
                 // unify result with known strings
-                auto it = knownStrings.find(result);
-                if (it == knownStrings.end()) {
-                    // a new string
-                    knownStrings.insert(result);
-                    owned.push_back(result);
-                } else {
-                    // a string that exists already;
-                    // the string cannot be from the file, so set the id
-                    delete result;
-                    result = *it;
-                    IDs[result] = index;
+                if (interning.load(std::memory_order_relaxed)) {
+                    auto it = knownStrings.find(result);
+                    if (it == knownStrings.end()) {
+                        // a new string
+                        knownStrings.insert(result);
+                    } else {
+                        // a string that exists already;
+                        // the string cannot be from the file, so set the id
+                        str.clear();
+                        str.shrink_to_fit();
+                        result = *it;
+                        IDs[result] = index;
+                    }
                 }
 
                 idMap[index] = (void *)result;
@@ -150,6 +183,40 @@ class StringPool final : public fieldTypes::HullType {
         }
     }
 
+    /**
+     * View a string by the id it had inside of the read file. In contrast to
+     * byID, this will neither allocate nor copy, if the string has not been
+     * read yet.
+     *
+     * @note views of strings that have not been read are invalidated by
+     * loadLazyData, i.e. by flush and close
+     */
+    api::StringView view(ObjectID index) const {
+        if (index <= 0 || index > lastID)
+            throw std::out_of_range("index of StringPool::view out of range");
+
+        auto result = static_cast<ogss::api::String>(idMap[index]);
+        if (result)
+            return api::StringView{result->data(), result->size()};
+
+        const uint64_t off = positions[index];
+        return in->view(off >> 32LU, (uint32_t)off);
+    }
+
+    /**
+     * @return the largest id that can be passed to byID and view
+     */
+    ObjectID lastStringID() const { return lastID; }
+
+    /**
+     * Unify all strings read so far with known strings. Afterwards, strings
+     * read from the file are unified as they are read.
+     *
+     * @note this is a no-op, unless the file was opened read-only
+     * @note strings that equal a known string become its aliases
+     */
+    void intern() const;
+
     /**
      * Ensure that all Strings have been read.
      */
@@ -19,11 +19,10 @@ namespace internal {
  */
 template <class T> class SubPool final : public Pool<T> {
 
-    void allocateInstances() final {
-        this->book = new Book<T>(this->staticDataInstances);
-        T *page = this->book->firstPage();
-        ObjectID i = this->bpo;
-        const auto last = i + this->staticDataInstances;
+    void createInstances(ObjectID begin, const ObjectID end) final {
+        T *page = this->book->firstPage() + begin;
+        ObjectID i = this->bpo + begin;
+        const auto last = this->bpo + end;
         while (i < last) {
             const int j = i + 1;
             // note: the first page consist of fresh instances. So, placement
@@ -51,7 +50,8 @@ template <class T> class SubPool final : public Pool<T> {
             this->book = new Book<T>();
         }
         T *rval = this->book->next();
-        new (rval) T(-1, this);
+        new (rval)
+          T(-1 - static_cast<ObjectID>(this->newObjects.size()), this);
         this->newObjects.push_back(rval);
         return rval;
     };
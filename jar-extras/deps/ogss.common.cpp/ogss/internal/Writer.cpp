@@ -2,7 +2,13 @@
 // Created by Timm Felden on 05.04.19.
 //
 
+#include <cstring>
 #include <future>
+#include <memory>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #include "../api/File.h"
 #include "../fieldTypes/HullType.h"
@@ -21,7 +27,21 @@ using ogss::fieldTypes::HullType;
 using ogss::streams::BufferedOutStream;
 
 Writer::Writer(api::File *state, streams::FileOutputStream &out) :
-  resultLock(), results(), errors(), awaitBuffers(0) {
+  errorLock(), errors(), failed(false), finished(), startedTasks(0),
+  completedTasks(0), awaitBuffers(0),
+  chunkSize(state->chunkSize),
+  writeBudget(state->writeBudget),
+  pending(0),
+  budgetLock(),
+  budgetFreed(),
+  positional(state->parallelWrite && out.positionalWrites()
+               ? &out
+               : nullptr),
+  nextOffset(0),
+  positionalStart(),
+  positionalReady(positionalStart.get_future().share()),
+  executor(*state->executor),
+  exits(startedTasks) {
     /**
      * *************** * G * ****************
      */
@@ -53,93 +73,152 @@ Writer::Writer(api::File *state, streams::FileOutputStream &out) :
             sp->IDs[s] = sp->idMap.size();
             sp->idMap.push_back((void *)s);
         }
+        // @note known strings of aliases are literals
+        for (const auto &a : sp->aliases)
+            sp->IDs[a.first] = sp->IDs[a.second];
         sp->hullOffset = sp->idMap.size();
     }
-    // write in parallel to writing of TF
-    auto SB = std::async(std::launch::async, StringPool::writeLiterals,
-                         (StringPool *)state->strings, &out);
 
-    /**
-     * *************** * T F * ****************
-     */
-    {
-        // write T and F to a buffer, while S is written
-        BufferedOutStream *const buffer = new BufferedOutStream();
-
-        // @note here, the field data write tasks will be started already
-        awaitBuffers = writeTF(state, *buffer);
-        SB.get();
-
-        // write buffered TF-blocks
-        out.write(buffer);
-    }
+    bool started = false;
+    try {
+        /**
+         * *************** * T F * ****************
+         */
+        {
+            // write T and F to a buffer
+            BufferedOutStream *const buffer = new BufferedOutStream(chunkSize);
 
-    /**
-     * *************** * HD * ****************
-     */
+            // @note here, the field data write tasks will be started already
+            writeTF(state, *buffer);
 
-    // await data from all HD tasks
-    bool hasErrors = false;
-    size_t i = 0;
-    for (; awaitBuffers != 0; awaitBuffers--, i++) {
-        std::shared_future<BufferedOutStream *> *f = nullptr;
-        {
-            // if the writer is faster then encoders triggering hull fields, it
-            // could be that we have to await buffers which have not even been
-            // enqueued yet
-            while (true) {
-                {
-                    std::lock_guard<std::mutex> consumerLock(resultLock);
-                    if (!errors.empty()) {
-                        // if a task crashed, we will inevitably notice it here,
-                        // because sending its buffer is its last action
-                        hasErrors = true;
-                        // @note there is still a data race between successful
-                        // threads and crashing threads that may lead to a
-                        // crash; it would become harmless, if we get rid of
-                        // resultLock, because Writer is stack-local
-                        // @note we could also set a shutdown flag, if this is a
-                        // serious problem
-                        break;
-                    }
-                    if (i < results.size())
-                        break;
-                }
-                // yield CPU to worker threads while we do not hold the result
-                // lock
-                std::this_thread::yield();
-            }
-            if (hasErrors)
-                break;
+            // write S, while the field tasks are running
+            StringPool::writeLiterals((StringPool *)state->strings, &out);
 
-            std::lock_guard<std::mutex> consumerLock(resultLock);
-            f = &results[i];
+            // write buffered TF-blocks
+            out.write(buffer);
         }
-        BufferedOutStream *const buf = f->get();
-        if (buf) {
-            out.writeSized(buf);
+
+        // HD blocks can be placed behind TF from now on
+        if (positional) {
+            nextOffset = out.fileSize();
+            started = true;
+            positionalStart.set_value();
         }
-        // else: some buffer was discarded
-    }
 
-    // report errors
-    if (hasErrors) {
-        std::lock_guard<std::mutex> consumerLock(resultLock);
-        // await remaining buffers to prevent crashes
-        for (; awaitBuffers != 0; awaitBuffers--, i++) {
-            if (i < results.size()) {
-                auto buf = results.at(i).get();
-                // delete remaining successful buffers
+        /**
+         * *************** * HD * ****************
+         */
+
+        // write buffers in the order their tasks complete; HD blocks carry
+        // their field ID, hence their order does not matter
+        bool hasErrors = false;
+        for (; awaitBuffers != 0; awaitBuffers--) {
+            BufferedOutStream *const buf = finished.pop();
+            completedTasks++;
+
+            // a task reports its error before it completes, hence we notice
+            // failures while waiting for the remaining buffers
+            if (failed.load(std::memory_order_acquire)) {
+                release(buf);
                 delete buf;
+                hasErrors = true;
+                break;
+            }
+            if (buf) {
+                release(buf);
+                out.writeSized(buf);
             }
+            // else: some buffer was discarded or written by its task
+        }
+
+        // cut the file behind the last reserved block
+        if (positional && !hasErrors) {
+            out.truncate(nextOffset);
         }
 
-        std::stringstream ss;
-        ss << "write failed:";
-        for (auto &msg : errors) {
-            ss << "\n  " << msg;
+        // report errors
+        if (hasErrors) {
+            // await remaining tasks to prevent crashes
+            discard();
+
+            std::stringstream ss;
+            ss << "write failed:";
+            std::lock_guard<std::mutex> lock(errorLock);
+            for (auto &msg : errors) {
+                ss << "\n  " << msg;
+            }
+            throw ogss::Exception(ss.str());
         }
-        throw ogss::Exception(ss.str());
+    } catch (...) {
+        // tasks must neither wait for nor write to the file anymore
+        if (positional && !started)
+            positionalStart.set_exception(std::current_exception());
+        discard();
+        throw;
+    }
+}
+
+void Writer::discard() {
+    // a task starts its children before it completes; hence, no task is
+    // running and none will be started once all started tasks completed
+    while (completedTasks != startedTasks.load(std::memory_order_acquire)) {
+        BufferedOutStream *const buf = finished.pop();
+        release(buf);
+        delete buf;
+        completedTasks++;
+    }
+}
+
+void Writer::startField(DataField *f, BlockID block) {
+    startedTasks.fetch_add(1, std::memory_order_relaxed);
+    executor.run(new WriteField(this, f, block));
+}
+
+void Writer::startHull(const HullType *ht, BlockID block) {
+    startedTasks.fetch_add(1, std::memory_order_relaxed);
+    executor.run(new WriteHull(this, ht, block));
+}
+
+void Writer::fail(const std::string &message) {
+    std::lock_guard<std::mutex> lock(errorLock);
+    errors.push_back(message);
+    failed.store(true, std::memory_order_release);
+
+    // tasks must not wait for a budget the consumer will not free
+    std::lock_guard<std::mutex> budget(budgetLock);
+    budgetFreed.notify_all();
+}
+
+void Writer::awaitBudget() {
+    if (!writeBudget ||
+        pending.load(std::memory_order_relaxed) < writeBudget)
+        return;
+
+    std::unique_lock<std::mutex> lock(budgetLock);
+    while (pending.load() >= writeBudget && !failed.load())
+        budgetFreed.wait(lock);
+}
+
+void Writer::release(BufferedOutStream *buffer) {
+    if (!buffer)
+        return;
+
+    const size_t size = buffer->size();
+    const size_t before = pending.fetch_sub(size);
+    if (writeBudget && before >= writeBudget && before - size < writeBudget) {
+        std::lock_guard<std::mutex> lock(budgetLock);
+        budgetFreed.notify_all();
+    }
+}
+
+void Writer::Compress::run() {
+    concurrent::Semaphore::ScopedPermit release(barrier);
+    try {
+        compact(*c, p, begin, end, next);
+    } catch (std::exception &e) {
+        self->fail(e.what());
+    } catch (...) {
+        self->fail("compress task non-standard crash");
     }
 }
 
@@ -151,7 +230,7 @@ static inline void attr(FieldDeclaration *const p, BufferedOutStream &out) {
     out.i8(0);
 }
 
-uint32_t Writer::writeTF(api::File *const state, BufferedOutStream &out) {
+void Writer::writeTF(api::File *const state, BufferedOutStream &out) {
     uint32_t awaitHulls = 0;
 
     std::vector<DataField *> fieldQueue;
@@ -163,16 +242,27 @@ uint32_t Writer::writeTF(api::File *const state, BufferedOutStream &out) {
 
     // calculate new bpos, sizes, object IDs and compress data arrays
     {
-        std::vector<std::future<void>> barrier;
+        concurrent::Semaphore barrier;
+        int compressing = 0;
 
         const int classCount = state->classCount;
-        int *const bpos = new int[classCount];
-        for (int i = 0; i < classCount; i++) {
-            AbstractPool *const p = state->classes[i];
-            if (nullptr == p->super) {
-                barrier.push_back(
-                  std::async(std::launch::async, compress, p, bpos));
+        std::unique_ptr<int[]> bpos(new int[classCount]);
+        std::vector<Compaction> compactions;
+        compactions.reserve(classCount);
+        try {
+            for (int i = 0; i < classCount; i++) {
+                AbstractPool *const p = state->classes[i];
+                if (nullptr == p->super) {
+                    compactions.emplace_back(
+                      p, (api::Object **)((Pool<api::Object> *)p)->data);
+                    compress(compactions.back(), bpos.get(), barrier,
+                             compressing);
+                }
             }
+        } catch (...) {
+            // jobs refer to compactions
+            barrier.takeMany(compressing);
+            throw;
         }
 
         // write count of the type block
@@ -182,10 +272,21 @@ uint32_t Writer::writeTF(api::File *const state, BufferedOutStream &out) {
         fieldQueue.reserve(2 * classCount);
 
         // await jobs
-        for (auto &f : barrier)
-            f.get();
+        barrier.takeMany(compressing);
+
+        if (failed) {
+            for (Compaction &c : compactions) {
+                if (c.to != c.from)
+                    delete[] c.to;
+                for (auto &t : c.targets)
+                    free(t.data);
+            }
+            std::lock_guard<std::mutex> lock(errorLock);
+            throw ogss::Exception("compress failed: " + errors.front());
+        }
 
-        delete[] bpos;
+        for (Compaction &c : compactions)
+            finish(c, bpos.get());
 
         // write types
         for (int i = 0; i < classCount; i++) {
@@ -248,15 +349,10 @@ uint32_t Writer::writeTF(api::File *const state, BufferedOutStream &out) {
 
     // note: we cannot start field jobs immediately because they could decrement
     // deps to 0 multiple times in that case
-    {
-        std::lock_guard<std::mutex> rLock(resultLock);
-        // C++ bullshit: we have to reserve space for futures, because they
-        // would be deleted on resize :-(
-        results.reserve(fieldQueue.size() + awaitHulls);
-        for (DataField *f : fieldQueue) {
-            results.emplace_back(
-              std::async(std::launch::async, writeField, this, f, 0));
-        }
+    // fields + hull types; set before tasks can add their blocks
+    awaitBuffers = fieldQueue.size() + awaitHulls;
+    for (DataField *f : fieldQueue) {
+        startField(f, 0);
     }
 
     /**
@@ -289,12 +385,42 @@ uint32_t Writer::writeTF(api::File *const state, BufferedOutStream &out) {
     }
 
     out.close();
+}
+
+//! the number of instances compacted by a job; a multiple of 64
+static constexpr ogss::ObjectID COMPRESS_SLICE = 1 << 16;
+
+static inline unsigned popcount64(uint64_t v) noexcept {
+#ifdef _MSC_VER
+    return (unsigned)__popcnt64(v);
+#else
+    return (unsigned)__builtin_popcountll(v);
+#endif
+}
+
+static inline unsigned ctz64(uint64_t v) noexcept {
+#ifdef _MSC_VER
+    unsigned long r;
+    _BitScanForward64(&r, v);
+    return (unsigned)r;
+#else
+    return (unsigned)__builtin_ctzll(v);
+#endif
+}
 
-    // fields + hull types
-    return fieldQueue.size() + awaitHulls;
+inline ::ogss::api::Object *Writer::instance(AbstractPool *const p,
+                                            ::ogss::api::Object **const data,
+                                            const ObjectID i) {
+    const ogss::ObjectID statics = p->staticDataInstances;
+    return i < statics
+             ? data[p->bpo + i]
+             : ((Pool<::ogss::api::Object> *)p)->newObjects[i - statics];
 }
 
-void Writer::compress(AbstractPool *const base, int *bpos) {
+void Writer::compress(Compaction &c, int *bpos, concurrent::Semaphore &barrier,
+                      int &jobs) {
+    AbstractPool *const base = c.base;
+
     // create our part of the bpo in
     {
         int next = 0;
@@ -322,50 +448,171 @@ void Writer::compress(AbstractPool *const base, int *bpos) {
         }
     }
 
-    // reset layout of distributed fields
-    {
-        AbstractPool *p = base;
-        while (p) {
-            for (DataField *f : p->dataFields) {
-                if (auto df = dynamic_cast<DistributedField *>(f)) {
-                    df->compress(bpos[p->typeID - 10]);
-                }
+    // the layout of unchanged pools is kept in place
+    bool changed = base->modified();
+    for (AbstractPool *p = base; p; p = p->next)
+        changed |= p->bpo != bpos[p->typeID - 10];
+    if (!changed)
+        return;
+
+    // recycle deleted instances; only words with deletions are visited
+    for (AbstractPool *p = base; p; p = p->next) {
+        auto book = ((Pool<api::Object> *)p)->book;
+        const std::vector<uint64_t> &deleted = p->deleted;
+        for (size_t w = 0; w < deleted.size(); w++) {
+            for (uint64_t bits = deleted[w]; bits; bits &= bits - 1) {
+                book->free(instance(p, c.from, w * 64 + ctz64(bits)));
             }
-            p = p->next;
         }
     }
 
     // from now on, size will take deleted objects into account, thus d may
     // in fact be smaller then data!
-    ::ogss::api::Object **tmp = ((Pool<::ogss::api::Object> *)base)->data;
     base->allocateData();
-    ::ogss::api::Object **d = ((Pool<::ogss::api::Object> *)base)->data;
-    ((Pool<::ogss::api::Object> *)base)->data = tmp;
-    ObjectID pos = 0;
+    c.to = (api::Object **)((Pool<api::Object> *)base)->data;
+    ((Pool<api::Object> *)base)->data = c.from;
+
+    // rebuild distributed fields of pools whose instances changed
+    for (AbstractPool *p = base; p; p = p->next) {
+        for (DataField *f : p->dataFields) {
+            if (auto df = dynamic_cast<DistributedField *>(f)) {
+                if (p->modified()) {
+                    api::Box *const data = (api::Box *)malloc(
+                      std::max<size_t>(1, p->cachedSize) * sizeof(api::Box));
+                    if (!data)
+                        throw std::bad_alloc();
+                    c.targets.push_back(
+                      {df, data, bpos[p->typeID - 10] + 1});
+                }
+            }
+        }
+    }
 
-    {
-        auto is = base->allObjects();
-        while (is->hasNext()) {
-        	::ogss::api::Object *const i = is->next();
-            if (0 != i->id) {
-                d[pos] = i;
-                i->id = ++pos;
-            } else {
-                ((Pool<::ogss::api::Object> *)base->owner->pool(i))->book->free(i);
+    // compact slices of each pool in parallel; the position of a slice
+    // follows from the deletions before it
+    for (AbstractPool *p = base; p; p = p->next) {
+        const ObjectID size = p->staticSize();
+        const std::vector<uint64_t> &deleted = p->deleted;
+        ObjectID next = bpos[p->typeID - 10];
+        for (ObjectID i = 0; i < size; i += COMPRESS_SLICE) {
+            const ObjectID end = std::min(size, i + COMPRESS_SLICE);
+            executor.run(new Compress(this, &c, p, i, end, next, &barrier));
+            jobs++;
+
+            ObjectID survivors = end - i;
+            for (size_t w = i / 64; w < deleted.size() && w * 64 < (size_t)end;
+                 w++)
+                survivors -= popcount64(deleted[w]);
+            next += survivors;
+        }
+    }
+}
+
+void Writer::compact(const Compaction &c, AbstractPool *const p, ObjectID i,
+                     const ObjectID end, ObjectID next) {
+    // the distributed fields of p and its super pools
+    std::vector<const Compaction::Target *> fields;
+    for (const auto &t : c.targets) {
+        for (AbstractPool *s = p; s; s = s->super) {
+            if (s == t.f->owner) {
+                fields.push_back(&t);
+                break;
             }
         }
     }
-    delete[] tmp;
 
-    // update after compress for all sub-pools
-    AbstractPool *p = base;
+    const ObjectID statics = p->staticDataInstances;
+    const std::vector<uint64_t> &deleted = p->deleted;
+    while (i < end) {
+        // find the end of the run of survivors starting at i
+        ObjectID last = end;
+        for (size_t w = i / 64; w < deleted.size() && w * 64 < (size_t)end;
+             w++) {
+            uint64_t bits = deleted[w];
+            if (w == (size_t)i / 64)
+                bits &= ~(uint64_t)0 << (i % 64);
+            if (bits) {
+                last = std::min<ObjectID>(end, w * 64 + ctz64(bits));
+                break;
+            }
+        }
+
+        // static instances are moved as a whole
+        const ObjectID split = std::max(i, std::min(last, statics));
+        if (i < split) {
+            const ObjectID n = split - i;
+            api::Object **const to = c.to + next;
+            std::memcpy(to, c.from + p->bpo + i, n * sizeof(api::Object *));
+            for (ObjectID j = 0; j < n; j++)
+                to[j]->id = next + j + 1;
+
+            for (const Compaction::Target *t : fields) {
+                const DistributedField *const f = t->f;
+                std::memcpy(t->data + (next + 1 - t->firstID),
+                            f->data + (p->bpo + i + 1 - f->firstID),
+                            n * sizeof(api::Box));
+            }
+            next += n;
+        }
+
+        // new objects take their field data from newData
+        for (ObjectID j = split; j < last; j++) {
+            api::Object *const o = instance(p, c.from, j);
+            c.to[next] = o;
+            o->id = next + 1;
+
+            for (const Compaction::Target *t : fields) {
+                const auto &d = t->f->newData;
+                const auto v = d.find(o);
+                t->data[next + 1 - t->firstID] =
+                  d.end() == v ? api::Box{} : v->second;
+            }
+            next++;
+        }
 
+        // skip the deleted instance
+        i = last + 1;
+    }
+}
+
+void Writer::finish(Compaction &c, const int *bpos) {
+    if (c.to != c.from)
+        delete[] c.from;
+
+    for (const auto &t : c.targets) {
+        free(t.f->data);
+        t.f->data = t.data;
+        t.f->newData.clear();
+    }
+
+    // update after compress for all sub-pools
+    AbstractPool *p = c.base;
     do {
-        p->resetOnWrite(d);
+        for (DataField *f : p->dataFields) {
+            if (auto df = dynamic_cast<DistributedField *>(f)) {
+                df->firstID = bpos[p->typeID - 10] + 1;
+                df->lastID = df->firstID + p->cachedSize;
+            }
+        }
+        p->deleted.clear();
+        p->resetOnWrite(c.to);
         p->bpo = bpos[p->typeID - 10];
     } while ((p = p->next));
 }
 
+std::pair<const uint8_t *, size_t>
+Writer::unchanged(const DataField *f, BlockID block, int i, int last) {
+    const std::pair<const uint8_t *, size_t> none(nullptr, 0);
+    if ((size_t)block >= f->sources.size())
+        return none;
+
+    const auto &source = f->sources[block];
+    if (!source.first || f->marks.changed(i, last - 1, f->sourceEpoch))
+        return none;
+
+    return source;
+}
+
 BufferedOutStream *Writer::writeField(Writer *self, DataField *f,
                                       BlockID block) {
     try {
@@ -391,10 +638,8 @@ BufferedOutStream *Writer::writeField(Writer *self, DataField *f,
 
                     f->blocks = blockCount;
 
-                    std::lock_guard<std::mutex> rLock(self->resultLock);
                     for (int i = 1; i < blockCount; i++) {
-                        self->results.emplace_back(std::async(
-                          std::launch::async, writeField, self, f, i));
+                        self->startField(f, i);
                     }
                 }
             } else {
@@ -407,13 +652,21 @@ BufferedOutStream *Writer::writeField(Writer *self, DataField *f,
             i += bpo;
             h += bpo;
 
-            buffer = new BufferedOutStream();
+            buffer = new BufferedOutStream(self->chunkSize);
 
             buffer->v64(f->fieldID);
             if (count > ogss::FD_Threshold) {
                 buffer->v64(block);
             }
-            bool discard = f->write(i, h, buffer);
+            // copy unchanged blocks instead of encoding them again
+            const auto source = unchanged(f, block, i - bpo, h - bpo);
+            bool discard;
+            if (source.first) {
+                buffer->put(source.first, source.second);
+                discard = false;
+            } else {
+                discard = f->write(i, h, buffer);
+            }
 
             // close buffer and discard it if possible
             buffer->close();
@@ -431,21 +684,17 @@ BufferedOutStream *Writer::writeField(Writer *self, DataField *f,
         if (done) {
             if (auto ht = dynamic_cast<const HullType *>(f->type)) {
                 if (0 == --ht->deps) {
-                    std::lock_guard<std::mutex> rLock(self->resultLock);
-                    self->results.emplace_back(
-                      std::async(std::launch::async, writeHull, self, ht, 0));
+                    self->startHull(ht, 0);
                 }
             }
         }
 
-        return buffer;
+        return emit(self, buffer);
     } catch (std::exception &e) {
-        std::lock_guard<std::mutex> errLock(self->resultLock);
-        self->errors.emplace_back(e.what());
+        self->fail(e.what());
         return nullptr;
     } catch (...) {
-        std::lock_guard<std::mutex> errLock(self->resultLock);
-        self->errors.emplace_back("write task non-standard crash");
+        self->fail("write task non-standard crash");
         return nullptr;
     }
 }
@@ -471,22 +720,19 @@ BufferedOutStream *Writer::writeHull(Writer *self, const HullType *ht,
                         // we have to fork this task
                         int blockCount = (size - 1) / ogss::HD_Threshold;
 
-                        std::lock_guard<std::mutex> rLock(self->resultLock);
-
                         // @note we increment await by blockCount - 1
                         self->awaitBuffers += blockCount++;
 
                         t->blocks = blockCount;
                         for (int i = 1; i < blockCount; i++) {
-                            self->results.emplace_back(std::async(
-                              std::launch::async, writeHull, self, t, i));
+                            self->startHull(t, i);
                         }
                     }
                 } else {
                     hasblocks = true;
                 }
 
-                buffer = new BufferedOutStream();
+                buffer = new BufferedOutStream(self->chunkSize);
                 buffer->v64(t->fieldID);
                 buffer->v64(size);
                 if (size > ogss::HD_Threshold) {
@@ -504,7 +750,7 @@ BufferedOutStream *Writer::writeHull(Writer *self, const HullType *ht,
                 }
             }
         } else {
-            buffer = new BufferedOutStream();
+            buffer = new BufferedOutStream(self->chunkSize);
             bool discard = ((StringPool *)ht)->write(buffer);
 
             // close buffer and discard it if possible
@@ -520,9 +766,7 @@ BufferedOutStream *Writer::writeHull(Writer *self, const HullType *ht,
                   dynamic_cast<const fieldTypes::SingleArgumentType *>(ht)) {
                 if (auto bt = dynamic_cast<HullType *>(p->base)) {
                     if (0 == --bt->deps) {
-                        std::lock_guard<std::mutex> rLock(self->resultLock);
-                        self->results.push_back(std::async(
-                          std::launch::async, writeHull, self, bt, 0));
+                        self->startHull(bt, 0);
                     }
                 }
             } else if (dynamic_cast<const StringPool *>(ht)) {
@@ -531,29 +775,37 @@ BufferedOutStream *Writer::writeHull(Writer *self, const HullType *ht,
                 const auto mt = (fieldTypes::MapType<::ogss::api::Box, ::ogss::api::Box> *)ht;
                 if (auto bt = dynamic_cast<HullType *>(mt->keyType)) {
                     if (0 == --bt->deps) {
-                        std::lock_guard<std::mutex> rLock(self->resultLock);
-                        self->results.push_back(std::async(
-                          std::launch::async, writeHull, self, bt, 0));
+                        self->startHull(bt, 0);
                     }
                 }
                 if (auto bt = dynamic_cast<HullType *>(mt->valueType)) {
                     if (0 == --bt->deps) {
-                        std::lock_guard<std::mutex> rLock(self->resultLock);
-                        self->results.push_back(std::async(
-                          std::launch::async, writeHull, self, bt, 0));
+                        self->startHull(bt, 0);
                     }
                 }
             }
         }
 
-        return buffer;
+        return emit(self, buffer);
     } catch (std::exception &e) {
-        std::lock_guard<std::mutex> errLock(self->resultLock);
-        self->errors.emplace_back(e.what());
+        self->fail(e.what());
         return nullptr;
     } catch (...) {
-        std::lock_guard<std::mutex> errLock(self->resultLock);
-        self->errors.emplace_back("write task non-standard crash");
+        self->fail("write task non-standard crash");
+        return nullptr;
+    }
+}
+
+BufferedOutStream *Writer::emit(Writer *self, BufferedOutStream *buffer) {
+    if (buffer && self->positional) {
+        // the task writes its own block once the blocks before HD are written
+        // @note the buffer is released, if the write has failed before HD
+        std::unique_ptr<BufferedOutStream> owner(buffer);
+        self->positionalReady.get();
+        self->positional->writeSizedAt(owner.release(), self->nextOffset);
         return nullptr;
     }
+    if (buffer)
+        self->pending += buffer->size();
+    return buffer;
 }
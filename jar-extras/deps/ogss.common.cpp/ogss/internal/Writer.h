@@ -5,7 +5,11 @@
 #ifndef OGSS_TEST_CPP_WRITER_H
 #define OGSS_TEST_CPP_WRITER_H
 
+#include "../concurrent/MPSCQueue.h"
+#include "../concurrent/Executor.h"
+#include "../concurrent/Semaphore.h"
 #include "../fieldTypes/HullType.h"
+#include <condition_variable>
 #include <future>
 #include <mutex>
 
@@ -22,19 +26,163 @@ namespace internal {
  * @author Timm Felden
  */
 class Writer final {
-    /// prevent that the buffer consumer interferes with a hull task
-    /// @note this should go; we should use a non-blocking queue instead
-    std::mutex resultLock;
-    std::vector<std::shared_future<BufferedOutStream *>> results;
+    //! protects errors
+    std::mutex errorLock;
     std::vector<std::string> errors;
 
+    //! set, once a task reported an error
+    std::atomic<bool> failed;
+
+    /**
+     * Buffers of completed tasks in completion order. Tasks push nullptr if
+     * their buffer was discarded or written by themselves.
+     */
+    concurrent::MPSCQueue<BufferedOutStream *> finished;
+
+    //! the number of tasks started so far
+    std::atomic<size_t> startedTasks;
+
+    //! the number of buffers taken from finished by the consumer
+    size_t completedTasks;
+
+    //! the number of buffers the consumer still has to take
     std::atomic<uint32_t> awaitBuffers;
 
+    //! the chunk size of buffers created by this writer
+    const size_t chunkSize;
+
+    //! the maximum number of bytes in finished; 0 if there is no limit
+    const size_t writeBudget;
+
+    //! the number of bytes of buffers in finished
+    std::atomic<size_t> pending;
+
+    std::mutex budgetLock;
+    //! notified, when pending drops below writeBudget or a task failed
+    std::condition_variable budgetFreed;
+
+    /**
+     * If not null, HD blocks are written to this stream by the tasks that
+     * create them.
+     */
+    streams::FileOutputStream *const positional;
+
+    /**
+     * The offset of the next free byte of the file, once positionalReady
+     * is ready.
+     */
+    std::atomic<size_t> nextOffset;
+
+    std::promise<void> positionalStart;
+
+    //! ready, once S and TF have been written
+    std::shared_future<void> positionalReady;
+
+    /**
+     * Executes all tasks of this writer. The tasks form a graph: field tasks
+     * fork tasks for further blocks and start the hull tasks whose deps they
+     * count down to zero.
+     */
+    concurrent::Executor &executor;
+
+    /**
+     * Waits for the exit of all started tasks on destruction. The executor
+     * outlives this writer, hence tasks may still run after their buffer has
+     * been taken from finished.
+     *
+     * @note declared last, so that tasks have exited before anything they
+     * might use is destroyed
+     */
+    struct Exits final {
+        //! released by each task as its last action
+        concurrent::Semaphore exited;
+        const std::atomic<size_t> &started;
+
+        explicit Exits(const std::atomic<size_t> &started) :
+          exited(), started(started) {}
+
+        ~Exits() { exited.takeMany((int32_t)started.load()); }
+    } exits;
+
     Writer(api::File *state, streams::FileOutputStream &out);
 
-    uint32_t writeTF(api::File *state, BufferedOutStream &out);
+    /**
+     * Write T and F to out and start the field tasks.
+     */
+    void writeTF(api::File *state, BufferedOutStream &out);
+
+    /**
+     * The compaction of the instances of a base pool and of the distributed
+     * fields of its pools into the layout of the file being written.
+     */
+    struct Compaction {
+        AbstractPool *const base;
+
+        //! the data array of base
+        api::Object **const from;
+
+        //! the compacted data array; from, if nothing changed
+        api::Object **to;
+
+        //! a distributed field whose data is rebuilt
+        struct Target {
+            DistributedField *const f;
+            //! the new data of f
+            api::Box *const data;
+            //! the ID corresponding to data[0]
+            const ObjectID firstID;
+        };
+        std::vector<Target> targets;
 
-    static void compress(AbstractPool *base, int *bpos);
+        Compaction(AbstractPool *base, api::Object **from) :
+          base(base),
+          from(from),
+          to(from),
+          targets() {}
+    };
+
+    //! @return the i-th instance of p in static order
+    static api::Object *instance(AbstractPool *p, api::Object **data,
+                                 ObjectID i);
+
+    /**
+     * Calculate sizes and bpos of c.base and start jobs compacting its
+     * instances. The jobs are counted in jobs.
+     */
+    void compress(Compaction &c, int *bpos, concurrent::Semaphore &barrier,
+                  int &jobs);
+
+    /**
+     * Move survivors of the instances [i; end[ of p in static order to
+     * c.to[next] onwards.
+     */
+    static void compact(const Compaction &c, AbstractPool *p, ObjectID i,
+                        ObjectID end, ObjectID next);
+
+    /**
+     * Install the result of c after all of its jobs completed.
+     */
+    static void finish(Compaction &c, const int *bpos);
+
+    //! start a task writing a block of f
+    void startField(DataField *f, BlockID block);
+
+    //! start a task writing a block of ht
+    void startHull(const fieldTypes::HullType *ht, BlockID block);
+
+    //! report an error of a task; the write will fail
+    void fail(const std::string &message);
+
+    //! wait until pending is below writeBudget or a task failed
+    void awaitBudget();
+
+    //! account for a buffer taken from finished
+    void release(BufferedOutStream *buffer);
+
+    /**
+     * Wait for all started tasks and delete the buffers not yet taken.
+     */
+    void discard();
 
     /**
      * writing a field can trigger writing a hull, hence we require access to
@@ -43,12 +191,84 @@ class Writer final {
     static BufferedOutStream *writeField(Writer *self, DataField *f,
                                          BlockID block);
 
+    /**
+     * @return the encoded block read from file, if the data of f of the
+     * instances of its owner in [i; last[ has not been changed since;
+     * {nullptr, 0} otherwise
+     */
+    static std::pair<const uint8_t *, size_t>
+    unchanged(const DataField *f, BlockID block, int i, int last);
+
     /**
      * writing a hull can trigger more hulls, hence we require access to results
      */
     static BufferedOutStream *
     writeHull(Writer *self, const fieldTypes::HullType *f, BlockID block);
 
+    /**
+     * Hand a finished buffer to the file, if writes are positional.
+     *
+     * @return the buffer, if it has to be written by the consumer
+     */
+    static BufferedOutStream *emit(Writer *self, BufferedOutStream *buffer);
+
+    struct Compress final : public concurrent::Job {
+        Writer *const self;
+        const Compaction *const c;
+        AbstractPool *const p;
+        const ObjectID begin;
+        const ObjectID end;
+        const ObjectID next;
+        concurrent::Semaphore *const barrier;
+
+        Compress(Writer *self, const Compaction *c, AbstractPool *p,
+                 ObjectID begin, ObjectID end, ObjectID next,
+                 concurrent::Semaphore *barrier) :
+          self(self),
+          c(c),
+          p(p),
+          begin(begin),
+          end(end),
+          next(next),
+          barrier(barrier) {}
+
+        void run() final;
+    };
+
+    struct WriteField final : public concurrent::Job {
+        Writer *const self;
+        DataField *const f;
+        const BlockID block;
+
+        WriteField(Writer *self, DataField *f, BlockID block) :
+          self(self),
+          f(f),
+          block(block) {}
+
+        void run() final {
+            concurrent::Semaphore::ScopedPermit exit(&self->exits.exited);
+            self->awaitBudget();
+            self->finished.push(writeField(self, f, block));
+        }
+    };
+
+    struct WriteHull final : public concurrent::Job {
+        Writer *const self;
+        const fieldTypes::HullType *const ht;
+        const BlockID block;
+
+        WriteHull(Writer *self, const fieldTypes::HullType *ht, BlockID block) :
+          self(self),
+          ht(ht),
+          block(block) {}
+
+        void run() final {
+            concurrent::Semaphore::ScopedPermit exit(&self->exits.exited);
+            self->awaitBudget();
+            self->finished.push(writeHull(self, ht, block));
+        }
+    };
+
     friend class api::File;
 };
 } // namespace internal
@@ -0,0 +1,200 @@
+//
+// Created on 17.10.26.
+//
+
+#include "BufferPool.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+using namespace ogss::streams;
+
+namespace {
+
+/**
+ * Header in front of each chunk.
+ */
+struct Chunk {
+    Chunk *next;
+    //! the usable size of the chunk
+    size_t size;
+};
+
+inline uint8_t *data(Chunk *c) { return reinterpret_cast<uint8_t *>(c + 1); }
+
+inline Chunk *header(uint8_t *chunk) {
+    return reinterpret_cast<Chunk *>(chunk) - 1;
+}
+
+std::atomic<size_t> currentSize(BufferPool::DEFAULT_CHUNK_SIZE);
+
+//! number of size classes, i.e. powers of two from MIN_CHUNK_SIZE to
+//! MAX_POOLED_SIZE
+constexpr size_t CLASSES = 19;
+static_assert((BufferPool::MIN_CHUNK_SIZE << (CLASSES - 1)) ==
+                BufferPool::MAX_POOLED_SIZE,
+              "size classes do not match pooled sizes");
+
+//! number of independent lists of shared chunks per size class
+constexpr size_t STRIPES = 16;
+
+/**
+ * Chunks shared between threads. Surplus chunks of a thread are spread over
+ * the stripes in batches so that threads taking chunks do not empty the
+ * shared pool at once.
+ *
+ * @note chunks are pushed one list at a time and only taken as a whole, i.e.
+ * there is no pop that could suffer from ABA
+ */
+std::atomic<Chunk *> shared[CLASSES][STRIPES];
+
+//! @return the size class of chunks of at least size bytes
+inline size_t sizeClass(size_t size) noexcept {
+    size_t c = 0;
+    while ((BufferPool::MIN_CHUNK_SIZE << c) < size)
+        c++;
+    return c;
+}
+
+//! push the list first..last to a stripe
+void share(std::atomic<Chunk *> &stripe, Chunk *first, Chunk *last) noexcept {
+    Chunk *h = stripe.load(std::memory_order_relaxed);
+    do {
+        last->next = h;
+    } while (!stripe.compare_exchange_weak(h, first, std::memory_order_release,
+                                           std::memory_order_relaxed));
+}
+
+void freeAll(Chunk *c) noexcept {
+    while (c) {
+        Chunk *const n = c->next;
+        free(c);
+        c = n;
+    }
+}
+
+/**
+ * Chunks of one size class cached by the current thread.
+ */
+struct Cache {
+    Chunk *head;
+    size_t count;
+};
+
+/**
+ * Chunks cached by the current thread. The caches are moved to shared once
+ * the thread terminates.
+ */
+struct Caches {
+    Cache classes[CLASSES];
+
+    //! the stripe used next by this thread
+    size_t stripe;
+
+    Caches() :
+      classes(),
+      stripe(std::hash<std::thread::id>()(std::this_thread::get_id())) {}
+
+    ~Caches() {
+        for (size_t c = 0; c < CLASSES; c++)
+            while (classes[c].head)
+                spill(c);
+    }
+
+    //! move a batch of cached chunks of size class c to the next stripe
+    void spill(size_t c) noexcept {
+        Cache &cache = classes[c];
+        Chunk *const first = cache.head;
+        Chunk *last = first;
+        size_t n = 1;
+        while (last->next && n < BufferPool::CACHE_LIMIT / 2) {
+            last = last->next;
+            n++;
+        }
+        cache.head = last->next;
+        cache.count -= n;
+        share(shared[c][stripe++ % STRIPES], first, last);
+    }
+
+    //! take all chunks of size class c of the first nonempty stripe
+    bool refill(size_t c) noexcept {
+        for (size_t i = 0; i < STRIPES; i++, stripe++) {
+            Chunk *h = shared[c][stripe % STRIPES].exchange(
+              nullptr, std::memory_order_acquire);
+            if (h) {
+                Cache &cache = classes[c];
+                cache.head = h;
+                cache.count = 0;
+                for (; h; h = h->next)
+                    cache.count++;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+thread_local Caches caches;
+} // namespace
+
+size_t BufferPool::chunkSize() noexcept {
+    return currentSize.load(std::memory_order_relaxed);
+}
+
+void BufferPool::setChunkSize(size_t size) {
+    if (size < MIN_CHUNK_SIZE)
+        throw std::invalid_argument("chunk size too small");
+    currentSize.store(size, std::memory_order_relaxed);
+}
+
+uint8_t *BufferPool::acquire(size_t &size) {
+    if (size < MIN_CHUNK_SIZE)
+        size = MIN_CHUNK_SIZE;
+
+    if (size <= MAX_POOLED_SIZE) {
+        const size_t c = sizeClass(size);
+        size = MIN_CHUNK_SIZE << c;
+
+        Cache &cache = caches.classes[c];
+        if (cache.head || caches.refill(c)) {
+            Chunk *const r = cache.head;
+            cache.head = r->next;
+            cache.count--;
+            return data(r);
+        }
+    }
+
+    Chunk *const c = static_cast<Chunk *>(malloc(sizeof(Chunk) + size));
+    if (!c)
+        throw std::bad_alloc();
+    c->size = size;
+    return data(c);
+}
+
+void BufferPool::release(uint8_t *chunk) noexcept {
+    Chunk *const r = header(chunk);
+    if (r->size > MAX_POOLED_SIZE) {
+        free(r);
+        return;
+    }
+
+    const size_t c = sizeClass(r->size);
+    Cache &cache = caches.classes[c];
+    r->next = cache.head;
+    cache.head = r;
+    if (++cache.count > CACHE_LIMIT)
+        caches.spill(c);
+}
+
+void BufferPool::trim() noexcept {
+    for (size_t c = 0; c < CLASSES; c++) {
+        for (auto &stripe : shared[c])
+            freeAll(stripe.exchange(nullptr, std::memory_order_acquire));
+        freeAll(caches.classes[c].head);
+        caches.classes[c].head = nullptr;
+        caches.classes[c].count = 0;
+    }
+}
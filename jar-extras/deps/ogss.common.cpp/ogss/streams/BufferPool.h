@@ -0,0 +1,74 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_CPP_STREAMS_BUFFERPOOL_H
+#define OGSS_COMMON_CPP_STREAMS_BUFFERPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ogss {
+namespace streams {
+
+/**
+ * A process-wide pool of the chunks used by buffered output streams.
+ *
+ * Chunks are cached per thread. Surplus chunks are moved to shared lock-free
+ * lists from where they are taken by threads with an empty cache. Hence,
+ * writing states repeatedly reaches a steady state without allocations.
+ *
+ * @note chunks are recycled per power-of-two size class; larger requests are
+ * rounded up
+ */
+class BufferPool final {
+    BufferPool() = delete;
+
+  public:
+    //! the initial default chunk size
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+
+    //! the smallest chunk size supported
+    static constexpr size_t MIN_CHUNK_SIZE = 64;
+
+    //! the largest chunk size that is recycled; larger chunks are freed
+    static constexpr size_t MAX_POOLED_SIZE = 1u << 24u;
+
+    //! number of chunks a thread keeps before moving half of them to the
+    //! shared lists
+    static constexpr size_t CACHE_LIMIT = 128;
+
+    /**
+     * @return the chunk size used by streams that do not request one
+     */
+    static size_t chunkSize() noexcept;
+
+    /**
+     * Set the chunk size used by streams that do not request one.
+     *
+     * @throws std::invalid_argument if size is below MIN_CHUNK_SIZE
+     */
+    static void setChunkSize(size_t size);
+
+    /**
+     * Take a chunk from the pool.
+     *
+     * @param size the requested size; set to the size of the returned chunk
+     * @return a chunk that has to be given back via release
+     */
+    static uint8_t *acquire(size_t &size);
+
+    /**
+     * Give a chunk back to the pool.
+     */
+    static void release(uint8_t *chunk) noexcept;
+
+    /**
+     * Free all chunks cached in the shared lists and by the calling thread.
+     */
+    static void trim() noexcept;
+};
+} // namespace streams
+} // namespace ogss
+
+#endif // OGSS_COMMON_CPP_STREAMS_BUFFERPOOL_H
@@ -6,25 +6,31 @@
 #define SKILL_CPP_COMMON_BUFFEREDOUTSTREAM_H
 
 #include "../api/Box.h"
+#include "BufferPool.h"
 #include "FileOutputStream.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <stdexcept>
 #include <vector>
 
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
 namespace ogss {
 namespace streams {
 
 /**
  * Buffered output streams.
  *
- * @note in contrast to OGSS/JVM, buffers will not be recycled because C++
- * stdlib lacks the required data structures
+ * @note buffers are recycled through the process-wide BufferPool
  * @note in contrast to OGSS/JVM, we can directly write bools to the last byte,
  * what makes BoolWrapper pointless
  */
 class BufferedOutStream {
+    friend class ChunkList;
     friend class FileOutputStream;
 
     //! number of bytes written to the file; used for truncation on close
@@ -41,9 +47,13 @@ class BufferedOutStream {
         const int size;
     };
 
-    // @note inv: current.size is == BUFFER_SIZE
+    // @note inv: current.size is the size of the chunk taken from BufferPool,
+    // or zero if there is none yet
     Buffer current;
 
+    //! the size of chunks requested from BufferPool
+    const size_t chunkSize;
+
     /**
      * Offset of last boolean operation. We start with a full byte, because the
      * first last byte has to be the absolute first byte.
@@ -68,10 +78,44 @@ class BufferedOutStream {
             flush();
     }
 
+    /**
+     * Pack eight booleans per byte, LSB first, into count bytes of target.
+     */
+    static inline void packBooleans(uint8_t *target, const bool *values,
+                                    size_t count) noexcept {
+        static_assert(sizeof(bool) == 1, "booleans are expected to be bytes");
+#if defined(__AVX2__)
+        // 32 booleans at once: move bit 0 of each byte to its sign bit
+        for (; count >= 4; count -= 4, target += 4, values += 32) {
+            const uint32_t w = (uint32_t)_mm256_movemask_epi8(_mm256_slli_epi16(
+              _mm256_loadu_si256((const __m256i *)values), 7));
+            std::memcpy(target, &w, 4);
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; count >= 2; count -= 2, target += 2, values += 16) {
+            const uint16_t w = (uint16_t)_mm_movemask_epi8(
+              _mm_slli_epi16(_mm_loadu_si128((const __m128i *)values), 7));
+            std::memcpy(target, &w, 2);
+        }
+#endif
+        for (; count; count--, values += 8) {
+            uint64_t w;
+            std::memcpy(&w, values, 8);
+#ifdef __BMI2__
+            *(target++) = (uint8_t)_pext_u64(w, 0x0101010101010101ULL);
+#else
+            // gather bit 0 of byte i in bit 56+i
+            *(target++) = (uint8_t)(((w & 0x0101010101010101ULL) *
+                                     0x0102040810204080ULL) >> 56U);
+#endif
+        }
+    }
+
   public:
-    BufferedOutStream() :
+    explicit BufferedOutStream(size_t chunkSize = BufferPool::chunkSize()) :
       bytesWriten(0),
       current({nullptr, nullptr, 0}),
+      chunkSize(chunkSize),
       off(7),
       completed() {}
 
@@ -81,7 +125,7 @@ class BufferedOutStream {
     ~BufferedOutStream() {
         for (auto &b : completed)
             if (b.size > 0)
-                free(b.begin);
+                BufferPool::release(b.begin);
     }
 
     static inline bool boolBox(api::Box v, streams::BufferedOutStream *out) {
@@ -103,6 +147,35 @@ class BufferedOutStream {
         }
     }
 
+    /**
+     * Write count consecutive booleans.
+     *
+     * @note whole bytes are packed from eight booleans at once
+     */
+    void booleans(const bool *values, size_t count) {
+        // fill the current byte
+        while (count && 7 != off) {
+            boolean(*(values++));
+            count--;
+        }
+
+        while (count >= 8) {
+            if (current.end == current.begin)
+                flush();
+
+            const size_t bytes =
+              std::min(count / 8U, (size_t)(current.end - current.begin));
+            packBooleans(current.begin, values, bytes);
+            current.begin += bytes;
+            values += 8U * bytes;
+            count -= 8U * bytes;
+        }
+
+        while (count--) {
+            boolean(*(values++));
+        }
+    }
+
     static inline bool i8Box(api::Box v, streams::BufferedOutStream *out) {
         out->i8(v.i8);
         return 0 == v.i8;
@@ -172,81 +245,39 @@ class BufferedOutStream {
         if (p < 0)
             throw std::logic_error("value not v32");
 
-        auto v = ::ogss::unsign(p);
-        require(5);
-
-        if (v < 0x80U) {
-            *(current.begin++) = (uint8_t)(v);
-        } else {
-            *(current.begin++) = (uint8_t)((0x80U | v));
-            if (v < 0x4000u) {
-                *(current.begin++) = (uint8_t)((v >> 7u));
-            } else {
-                *(current.begin++) = (uint8_t)((0x80U | v >> 7u));
-                if (v < 0x200000u) {
-                    *(current.begin++) = (uint8_t)((v >> 14u));
-                } else {
-                    *(current.begin++) = (uint8_t)((0x80U | v >> 14u));
-                    if (v < 0x10000000u) {
-                        *(current.begin++) = (uint8_t)((v >> 21u));
-                    } else {
-                        *(current.begin++) = (uint8_t)((0x80U | v >> 21u));
-                        *(current.begin++) = (uint8_t)((v >> 28u));
-                    }
-                }
-            }
-        }
+        require(9);
+        current.begin +=
+          FileOutputStream::encodeV64(current.begin, ::ogss::unsign(p));
     }
 
     inline void v64(int64_t p) {
-        auto v = ::ogss::unsign(p);
         require(9);
+        current.begin +=
+          FileOutputStream::encodeV64(current.begin, ::ogss::unsign(p));
+    }
 
-        if (v < 0x80U) {
-            *(current.begin++) = (uint8_t)(v);
-        } else {
-            *(current.begin++) = (uint8_t)((0x80U | v));
-            if (v < 0x4000U) {
-                *(current.begin++) = (uint8_t)((v >> 7u));
-            } else {
-                *(current.begin++) = (uint8_t)((0x80U | v >> 7u));
-                if (v < 0x200000U) {
-                    *(current.begin++) = (uint8_t)((v >> 14u));
-                } else {
-                    *(current.begin++) = (uint8_t)((0x80U | v >> 14u));
-                    if (v < 0x10000000U) {
-                        *(current.begin++) = (uint8_t)((v >> 21u));
-                    } else {
-                        *(current.begin++) = (uint8_t)((0x80U | v >> 21u));
-                        if (v < 0x800000000U) {
-                            *(current.begin++) = (uint8_t)((v >> 28u));
-                        } else {
-                            *(current.begin++) = (uint8_t)((0x80U | v >> 28u));
-                            if (v < 0x40000000000U) {
-                                *(current.begin++) = (uint8_t)((v >> 35u));
-                            } else {
-                                *(current.begin++) =
-                                  (uint8_t)((0x80U | v >> 35u));
-                                if (v < 0x2000000000000U) {
-                                    *(current.begin++) = (uint8_t)((v >> 42u));
-                                } else {
-                                    *(current.begin++) =
-                                      (uint8_t)((0x80U | v >> 42u));
-                                    if (v < 0x100000000000000U) {
-                                        *(current.begin++) =
-                                          (uint8_t)((v >> 49u));
-                                    } else {
-                                        *(current.begin++) =
-                                          (uint8_t)((0x80U | v >> 49u));
-                                        *(current.begin++) =
-                                          (uint8_t)((v >> 56u));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
+    /**
+     * Write count consecutive v64 values.
+     *
+     * @note in contrast to calling v64 in a loop, free space is checked once
+     * for all values that fit into the current buffer
+     */
+    void v64s(const int64_t *values, size_t count) {
+        while (count) {
+            size_t n = (size_t)(current.end - current.begin) / 9U;
+            if (!n) {
+                flush();
+                continue;
             }
+            if (n > count)
+                n = count;
+
+            uint8_t *p = current.begin;
+            for (size_t j = 0; j < n; j++)
+                p += FileOutputStream::encodeV64(p, ::ogss::unsign(values[j]));
+            current.begin = p;
+            values += n;
+            count -= n;
         }
     }
 
@@ -262,8 +293,8 @@ class BufferedOutStream {
     void put(const uint8_t *data, const size_t size) {
         // write the byte[] directly, if it is too large to be cached
         // efficiently
-        if (size > FileOutputStream::BUFFER_SIZE / 2) {
-            if (current.end - current.begin != FileOutputStream::BUFFER_SIZE)
+        if (size > chunkSize / 2) {
+            if (current.end - current.begin != current.size)
                 flush();
             int wrapSize = -(long)size;
             Buffer wrap = {const_cast<uint8_t *>(data), data + size, wrapSize};
@@ -278,20 +309,24 @@ class BufferedOutStream {
         }
     }
 
+    /**
+     * @return the number of bytes in completed chunks
+     */
+    size_t size() const noexcept { return bytesWriten; }
+
     /**
      * Ensure that current is flushed to completed and no dead memory would be
      * leaked.
      */
     void close() {
         if (current.begin) {
-            int p =
-              FileOutputStream::BUFFER_SIZE - (current.end - current.begin);
+            int p = current.size - (current.end - current.begin);
             if (p) {
                 completed.emplace_back(
                   Buffer({current.begin - p, current.end, p}));
                 bytesWriten += p;
             } else {
-                free(current.begin);
+                BufferPool::release(current.begin);
             }
         }
     }
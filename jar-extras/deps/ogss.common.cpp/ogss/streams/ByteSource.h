@@ -0,0 +1,32 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_CPP_BYTESOURCE_H
+#define OGSS_CPP_BYTESOURCE_H
+
+#include <cstddef>
+
+namespace ogss {
+namespace streams {
+
+/**
+ * A sequential source of bytes that cannot be mapped, e.g. a pipe, a socket
+ * or a decompressor.
+ */
+class ByteSource {
+  public:
+    virtual ~ByteSource() = default;
+
+    /**
+     * read at most size bytes into target; may block until some bytes are
+     * available
+     *
+     * @return the number of bytes read; 0, iff the source is exhausted
+     */
+    virtual size_t read(void *target, size_t size) = 0;
+};
+} // namespace streams
+} // namespace ogss
+
+#endif // OGSS_CPP_BYTESOURCE_H
@@ -0,0 +1,67 @@
+//
+// Created on 17.10.26.
+//
+
+#include "ChunkList.h"
+#include "BufferedOutStream.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace ogss::streams;
+
+namespace {
+//! the minimum size of storage allocated for copies
+constexpr size_t COPY_STORAGE_SIZE = 4096;
+} // namespace
+
+ChunkList::ChunkList() :
+  owners(), copies(), copyPosition(nullptr), copyRemaining(0), list(),
+  bytes(0) {}
+
+ChunkList::~ChunkList() = default;
+
+void ChunkList::copy(const void *data, size_t size) {
+    if (!size)
+        return;
+
+    if (copyRemaining < size) {
+        const size_t n = std::max(size, COPY_STORAGE_SIZE);
+        copies.emplace_back(new uint8_t[n]);
+        copyPosition = copies.back().get();
+        copyRemaining = n;
+    }
+
+    std::memcpy(copyPosition, data, size);
+
+    // extend the last segment, if it ends where the copy begins
+    if (!list.empty() &&
+        (uint8_t *)list.back().iov_base + list.back().iov_len == copyPosition)
+        list.back().iov_len += size;
+    else
+        list.push_back({copyPosition, size});
+
+    copyPosition += size;
+    copyRemaining -= size;
+    bytes += size;
+}
+
+void ChunkList::take(BufferedOutStream *out) {
+    owners.emplace_back(out);
+    for (BufferedOutStream::Buffer &data : out->completed) {
+        // there is no need to distinguish wrapped from buffered data here
+        const size_t size = std::abs(data.size);
+        list.push_back({data.begin, size});
+        bytes += size;
+    }
+}
+
+void ChunkList::clear() noexcept {
+    owners.clear();
+    copies.clear();
+    copyPosition = nullptr;
+    copyRemaining = 0;
+    list.clear();
+    bytes = 0;
+}
@@ -0,0 +1,93 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_CPP_STREAMS_CHUNKLIST_H
+#define OGSS_COMMON_CPP_STREAMS_CHUNKLIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+namespace ogss {
+namespace streams {
+
+class BufferedOutStream;
+
+/**
+ * The bytes of a serialized state held in memory as a sequence of segments.
+ * The segments point into the chunks of the buffered streams that produced
+ * them, i.e. the data is not copied after serialization.
+ *
+ * @note the list owns all memory referenced by its segments
+ */
+class ChunkList final {
+  public:
+#ifndef _WIN32
+    //! a segment can be passed to writev, sendmsg or vmsplice directly
+    typedef struct iovec Segment;
+#else
+    struct Segment {
+        void *iov_base;
+        size_t iov_len;
+    };
+#endif
+
+  private:
+    friend class FileOutputStream;
+
+    //! the streams owning chunks referenced by list
+    std::vector<std::unique_ptr<BufferedOutStream>> owners;
+
+    //! storage of bytes that had to be copied, e.g. headers of blocks
+    std::vector<std::unique_ptr<uint8_t[]>> copies;
+
+    //! the first unused byte of the last element of copies
+    uint8_t *copyPosition;
+
+    //! the number of unused bytes of the last element of copies
+    size_t copyRemaining;
+
+    std::vector<Segment> list;
+
+    size_t bytes;
+
+    //! append a copy of data
+    void copy(const void *data, size_t size);
+
+    //! append the completed chunks of out; takes ownership of out
+    void take(BufferedOutStream *out);
+
+  public:
+    ChunkList();
+
+    ChunkList(ChunkList &&) = default;
+
+    ChunkList &operator=(ChunkList &&) = default;
+
+    ~ChunkList();
+
+    /**
+     * @return the segments in file order
+     */
+    const std::vector<Segment> &segments() const noexcept { return list; }
+
+    /**
+     * @return the total number of bytes
+     */
+    size_t size() const noexcept { return bytes; }
+
+    /**
+     * Release all chunks.
+     */
+    void clear() noexcept;
+};
+} // namespace streams
+} // namespace ogss
+
+#endif // OGSS_COMMON_CPP_STREAMS_CHUNKLIST_H
@@ -3,29 +3,71 @@
 //
 
 #ifdef _WIN32
+#include <io.h>
 #include <windows.h>
 #else
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <unistd.h>
 #endif
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
 #include "FileInputStream.h"
 
 using namespace ogss::streams;
 
+namespace {
+/**
+ * reads a file descriptor that cannot be mapped, e.g. a pipe or a socket
+ */
+class FDSource final : public ByteSource {
+    const int fd;
+
+  public:
+    //! @note takes ownership of fd
+    explicit FDSource(int fd) : fd(fd) {}
+
+    ~FDSource() final {
+#ifdef _WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    size_t read(void *target, size_t size) final {
+        while (true) {
+#ifdef _WIN32
+            const int r = ::_read(fd, target, (unsigned int) std::min(size, (size_t) INT32_MAX));
+#else
+            const ssize_t r = ::read(fd, target, size);
+#endif
+            if (r >= 0)
+                return (size_t) r;
+            if (EINTR != errno)
+                throw ogss::Exception(std::string("could not read file descriptor: ") + std::strerror(errno));
+        }
+    }
+};
+} // namespace
+
 #ifdef _WIN32
 FileInputStream::FileInputStream(void *begin, void *end, const std::string *path,
                 void *file, void *mapping):
-                InStream(begin, end), path(path), file(file), mapping(mapping) {
+                InStream(begin, end), path(path), source(), capacity(0), adviseBlocks(false), file(file), mapping(mapping) {
 }
 #else
 FileInputStream::FileInputStream(void *begin, void *end, const std::string* path, const FILE *file)
-        : InStream(begin, end), path(path), file(file) {
+        : InStream(begin, end), path(path), source(), capacity(0), adviseBlocks(false), file(file) {
 }
 #endif
 
 
 FileInputStream::FileInputStream(const std::string& path)
-        : InStream(nullptr, nullptr), path(new std::string(path)), file(nullptr) {
+        : InStream(nullptr, nullptr), path(new std::string(path)), source(), capacity(0), adviseBlocks(false), file(nullptr) {
 #ifdef _WIN32
     mapping = nullptr;
 
@@ -33,13 +75,140 @@ FileInputStream::FileInputStream(const std::string& path)
             nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
     if (stream == INVALID_HANDLE_VALUE)
         throw Exception(std::string("could not open file ") + path);
+    map(stream);
+#else
+    FILE *stream = fopen(path.c_str(), "r");
+
+    if (nullptr == stream)
+        throw Exception(std::string("could not open file ") + path);
+
+    map(stream);
+#endif
+}
+
+FileInputStream::FileInputStream(int fd)
+        : InStream(nullptr, nullptr), path(new std::string()), source(), capacity(0), adviseBlocks(false), file(nullptr) {
+#ifdef _WIN32
+    mapping = nullptr;
+
+    if (FILE_TYPE_DISK != ::GetFileType((HANDLE) ::_get_osfhandle(fd))) {
+        const int copy = ::_dup(fd);
+        if (-1 == copy)
+            throw Exception(std::string("could not open file descriptor ") + std::to_string(fd));
+        source.reset(new FDSource(copy));
+        return;
+    }
+
+    HANDLE stream;
+    if (!::DuplicateHandle(::GetCurrentProcess(), (HANDLE) ::_get_osfhandle(fd),
+            ::GetCurrentProcess(), &stream, 0, FALSE, DUPLICATE_SAME_ACCESS))
+        throw Exception(std::string("could not open file descriptor ") + std::to_string(fd));
+    map(stream);
+#else
+    const int copy = dup(fd);
+
+    // pipes, sockets and the like cannot be mapped
+    struct stat fileStat;
+    if (-1 != copy && 0 == fstat(copy, &fileStat) && !S_ISREG(fileStat.st_mode)) {
+        source.reset(new FDSource(copy));
+        return;
+    }
+
+    FILE *stream = -1 == copy ? nullptr : fdopen(copy, "r");
+
+    if (nullptr == stream) {
+        if (-1 != copy)
+            ::close(copy);
+        throw Exception(std::string("could not open file descriptor ") + std::to_string(fd));
+    }
+
+    map(stream);
+#endif
+}
+
+FileInputStream::FileInputStream(const void *buffer, size_t size)
+        : InStream(const_cast<void *>(buffer), (uint8_t *) const_cast<void *>(buffer) + size),
+          path(new std::string()), source(), capacity(0), adviseBlocks(false), file(nullptr) {
+#ifdef _WIN32
+    mapping = nullptr;
+#endif
+}
+
+FileInputStream::FileInputStream(ByteSource *source)
+        : InStream(nullptr, nullptr), path(new std::string()), source(source), capacity(0), adviseBlocks(false), file(nullptr) {
+#ifdef _WIN32
+    mapping = nullptr;
+#endif
+}
+
+void FileInputStream::fill(size_t n) {
+    size_t left = (uint8_t *) end - position;
+    if (left >= n)
+        return;
+
+    // drop consumed bytes
+    if (left && position != base)
+        std::memmove(base, position, left);
+
+    if (capacity < n) {
+        capacity = std::max(n, std::max(2 * capacity, (size_t) STREAM_BUFFER_SIZE));
+        void *grown = realloc(base, capacity);
+        if (!grown)
+            throw std::bad_alloc();
+        base = grown;
+    }
+
+    while (left < n) {
+        const size_t r = source->read((uint8_t *) base + left, capacity - left);
+        if (!r)
+            break;
+        left += r;
+    }
+
+    position = (uint8_t *) base;
+    end = position + left;
+}
+
+MappedInStream *FileInputStream::readBlock(size_t size) {
+    uint8_t *const block = (uint8_t *) malloc(size);
+    if (!block)
+        throw std::bad_alloc();
+
+    // take what is buffered already and read the rest directly
+    size_t done = std::min(size, (size_t) ((uint8_t *) end - position));
+    std::memcpy(block, position, done);
+    position += done;
+
+    while (done < size) {
+        const size_t r = source->read(block + done, size - done);
+        if (!r) {
+            free(block);
+            throw Exception("unexpected end of stream");
+        }
+        done += r;
+    }
+
+    return new MappedInStream(block, block, block + size, block);
+}
+
+#ifdef _WIN32
+bool FileInputStream::backedBy(const std::string &) const {
+    // there is no cheap identity check for paths; hence, any mapped file
+    // counts as a match
+    return nullptr != file;
+}
+
+void FileInputStream::map(void *stream) {
     auto length = ::GetFileSize(stream, nullptr);
-    if (length <= 0) return;
+    if (length <= 0) {
+        ::CloseHandle(stream);
+        return;
+    }
 
     auto mappedStream = ::CreateFileMappingA(stream, nullptr, PAGE_READONLY, 0, 0, nullptr);
     if (mappedStream == INVALID_HANDLE_VALUE) {
         ::CloseHandle(stream);
-        throw Exception(std::string("could not map file ") + path);
+        throw Exception(std::string("could not map file ") + *this->path);
     }
     void *base = position = static_cast<uint8_t*>(::MapViewOfFile(mappedStream, FILE_MAP_READ, 0, 0, length));
     void *end = position + length;
@@ -50,37 +219,77 @@ FileInputStream::FileInputStream(const std::string& path)
         throw Exception("Execution of MapViewOfFile failed.");
     }
     new(this) FileInputStream(base, end, this->path.get(), stream, mappedStream);
+}
 #else
-    FILE *stream = fopen(path.c_str(), "r");
+bool FileInputStream::backedBy(const std::string &path) const {
+    // buffers and streamed files do not depend on the file system
+    if (nullptr == file)
+        return false;
 
-    if (nullptr == stream)
-        throw Exception(std::string("could not open file ") + path);
+    struct stat target;
+    if (-1 == stat(path.c_str(), &target))
+        // the file does not exist and will be created
+        return false;
+
+    struct stat mapped;
+    if (-1 == fstat(fileno(const_cast<FILE *>(file)), &mapped))
+        return true;
 
+    return mapped.st_dev == target.st_dev && mapped.st_ino == target.st_ino;
+}
+
+void FileInputStream::map(FILE *stream) {
     struct stat fileStat;
-    if (-1 == fstat(fileno(stream), &fileStat))
+    if (-1 == fstat(fileno(stream), &fileStat)) {
+        fclose(stream);
         throw Exception("Execution of function fstat failed.");
+    }
 
     const size_t length = fileStat.st_size;
 
     if (!length) {
+        fclose(stream);
         return;
     }
 
-    void *base = position = (uint8_t *) mmap(nullptr, length, PROT_READ, MAP_SHARED, fileno(stream), 0);
+    const bool populate = length < POPULATE_LIMIT;
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate)
+        flags |= MAP_POPULATE;
+#endif
+
+    void *base = position = (uint8_t *) mmap(nullptr, length, PROT_READ, flags, fileno(stream), 0);
     void *end = position + length;
 
-    if (MAP_FAILED == base)
+    if (MAP_FAILED == base) {
+        fclose(stream);
         throw Exception("Execution of function mmap failed.");
+    }
 
-    if (-1 == posix_madvise(position, length, MADV_WILLNEED))
-        throw Exception("Execution of function madvise failed.");
+    if (populate) {
+        if (-1 == posix_madvise(position, length, MADV_WILLNEED))
+            throw Exception("Execution of function madvise failed.");
+#ifdef MADV_HUGEPAGE
+        // @note not all file systems support huge pages; hence, errors are
+        // ignored
+        madvise(position, length, MADV_HUGEPAGE);
+#endif
+    }
 
     // set begin and end
     new(this) FileInputStream(base, end, this->path.get(), stream);
-#endif
+    adviseBlocks = !populate;
 }
+#endif
 
 FileInputStream::~FileInputStream() {
+    if (source) {
+        free(base);
+        return;
+    }
+
 #ifdef _WIN32
     if (nullptr != file) {
         ::UnmapViewOfFile(base);
@@ -5,6 +5,7 @@
 #ifndef SKILL_CPP_COMMON_FILEINPUTSTREAM_H
 #define SKILL_CPP_COMMON_FILEINPUTSTREAM_H
 
+#include "ByteSource.h"
 #include "InStream.h"
 #include "MappedInStream.h"
 
@@ -22,6 +23,46 @@ namespace ogss {
              */
             std::unique_ptr<const std::string> path;
 
+            /**
+             * the source of a file that could not be mapped; in this case, base
+             * is a buffer holding the bytes received but not yet consumed
+             * @note null, iff the file is mapped
+             */
+            std::unique_ptr<ByteSource> source;
+
+            /**
+             * the capacity of the buffer of a streamed file
+             */
+            size_t capacity;
+
+            /**
+             * the initial capacity of the buffer of a streamed file
+             */
+            static constexpr size_t STREAM_BUFFER_SIZE = 16 * BUFFER_SIZE;
+
+        public:
+            /**
+             * Files smaller than this are populated completely when mapped and
+             * use huge pages where possible. Pages of larger files are
+             * requested per HD block to bound resident memory.
+             */
+            static constexpr size_t POPULATE_LIMIT = 64 << 20;
+
+        private:
+            /**
+             * true, iff HD blocks are requested from the OS just before they
+             * are read and dropped once consumed, i.e. iff the file is a large
+             * mapped file
+             */
+            bool adviseBlocks;
+
+            /**
+             * ensure that at least n bytes are buffered after position, unless
+             * the source is exhausted before
+             * @note consumed bytes are dropped from the buffer
+             */
+            void fill(size_t n);
+
             /**
              * the file object used for communication to the fs
              */
@@ -29,12 +70,18 @@ namespace ogss {
             void *file, *mapping; // HANDLE
             FileInputStream(void *begin, void *end, const std::string *path,
                     void *file, void *mapping);
+
+            //! map the file behind handle; takes ownership of the handle
+            void map(void *handle);
 #else
             const FILE *const file;
             /**
              * required for replacing begin and end after map
              */
             FileInputStream(void *begin, void *end, const std::string *path, const FILE *file);
+
+            //! map the file behind stream; takes ownership of the stream
+            void map(FILE *stream);
 #endif
 
         public:
@@ -44,6 +91,33 @@ namespace ogss {
              */
             FileInputStream(const std::string &path);
 
+            /**
+             * map the file behind a file descriptor
+             *
+             * @note the whole file is mapped regardless of the descriptor's
+             * offset
+             * @note the descriptor remains owned by the caller and can be
+             * closed after construction
+             */
+            explicit FileInputStream(int fd);
+
+            /**
+             * read from a buffer in memory
+             *
+             * @note the buffer remains owned by the caller and must outlive
+             * this stream and all streams created from it
+             */
+            FileInputStream(const void *buffer, size_t size);
+
+            /**
+             * read sequentially from a source that cannot be mapped
+             *
+             * @note takes ownership of source
+             * @note the file is buffered only as far as required; each HD
+             * block is read into a buffer owned by the stream mapping it
+             */
+            explicit FileInputStream(ByteSource *source);
+
             /**
              * close the stream
              */
@@ -63,12 +137,75 @@ namespace ogss {
             */
             MappedInStream *jumpAndMap(long offset) {
                 assert(offset > 0);
+                if (source)
+                    return readBlock(offset);
+
                 assert(position + offset <= end);
-                auto r = new MappedInStream(base, position, position + offset);
+                auto r = new MappedInStream(base, position, position + offset,
+                                            nullptr, adviseBlocks);
                 position += offset;
                 return r;
             }
 
+            /**
+             * @return true, iff the file is read sequentially instead of being
+             * mapped
+             */
+            bool streamed() const {
+                return nullptr != source;
+            }
+
+            /**
+             * @return true, if writing to path could change the bytes of this
+             * stream, i.e. if the stream maps the file at path
+             * @note the result is conservative; errors count as a match
+             */
+            bool backedBy(const std::string &path) const;
+
+            /*
+             * The parser reads everything before the HD blocks directly from
+             * this stream. Hence, the read functions used there refill the
+             * buffer of streamed files before delegating to InStream.
+             */
+
+            inline int8_t i8() {
+                if (source)
+                    fill(1);
+                return InStream::i8();
+            }
+
+            inline int32_t v32() {
+                if (source)
+                    fill(5);
+                return InStream::v32();
+            }
+
+            inline int64_t v64() {
+                if (source)
+                    fill(9);
+                return InStream::v64();
+            }
+
+            String literalString() {
+                if (!source)
+                    return InStream::literalString();
+
+                const uint32_t length = v32();
+                fill(length);
+                if ((uint8_t *) end - position < length)
+                    throw Exception("unexpected end of stream");
+
+                String rval = new std::string((const char *) position, length);
+                position += length;
+                return rval;
+            }
+
+            inline bool eof() {
+                if (source)
+                    fill(1);
+                return InStream::eof();
+            }
+
             /**
              * skip a part of the file
              */
@@ -82,6 +219,10 @@ namespace ogss {
             size_t size() {
                 return (uint8_t *) end - (uint8_t *) base;
             }
+
+        private:
+            //! read the next HD block of a streamed file into its own buffer
+            MappedInStream *readBlock(size_t size);
         };
     }
 }
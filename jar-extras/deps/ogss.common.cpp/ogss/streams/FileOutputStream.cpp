@@ -5,62 +5,445 @@
 #include "FileOutputStream.h"
 #include "../api/Exception.h"
 #include "BufferedOutStream.h"
+#include "ChunkList.h"
+#include "IOBackend.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 using namespace ogss::streams;
 
-FileOutputStream::FileOutputStream(const std::string &path) :
+#ifndef _WIN32
+namespace {
+
+//! number of chunks gathered into a single writev
+#if defined(IOV_MAX) && IOV_MAX < 1024
+constexpr int IOV_BATCH = IOV_MAX;
+#else
+constexpr int IOV_BATCH = 1024;
+#endif
+
+/**
+ * write all of iov, resuming after partial writes
+ *
+ * @param at if not null, the file offset to write to; advanced accordingly
+ */
+void writeFully(int fd, struct iovec *iov, int count, off_t *at) {
+    while (count) {
+        ssize_t r = at ? pwritev(fd, iov, count, *at) : writev(fd, iov, count);
+        if (r < 0) {
+            if (EINTR == errno)
+                continue;
+            throw ogss::Exception(std::string("write failed: ") +
+                                  std::strerror(errno));
+        }
+
+        if (at)
+            *at += r;
+
+        // skip the part that has been written
+        while (count && (size_t)r >= iov->iov_len) {
+            r -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count) {
+            iov->iov_base = (uint8_t *)iov->iov_base + r;
+            iov->iov_len -= r;
+        }
+    }
+}
+
+/**
+ * An asynchronous write of a copy of some bytes.
+ */
+struct CopyWrite final : public IOBackend::Write {
+    std::unique_ptr<uint8_t[]> data;
+
+    CopyWrite(const void *bytes, size_t size) : data(new uint8_t[size]) {
+        std::memcpy(data.get(), bytes, size);
+        iov.push_back({data.get(), size});
+    }
+};
+
+/**
+ * An asynchronous write of chunks of a buffered stream. The stream is
+ * deleted once all writes of its chunks are complete.
+ */
+struct ChunkWrite final : public IOBackend::Write {
+    const std::shared_ptr<BufferedOutStream> out;
+
+    //! bytes preceding the chunks, if any
+    std::vector<uint8_t> prefix;
+
+    explicit ChunkWrite(const std::shared_ptr<BufferedOutStream> &out) :
+      out(out), prefix() {}
+};
+} // namespace
+#endif
+
+// odr-used by std::max
+constexpr size_t FileOutputStream::DIRECT_ALIGNMENT;
+
+FileOutputStream::FileOutputStream(const std::string &path, size_t flushSize,
+                                   bool direct, bool async) :
   Stream(&buffer, static_cast<void*>(&buffer + BUFFER_SIZE)),
   path(path),
   file(fopen(path.c_str(), "w+")),
-  bytesWriten(0) {
+  memory(nullptr),
+  chunks(nullptr),
+  bytesWriten(0),
+  flushSize(flushSize),
+  directFd(-1),
+  staging(nullptr),
+  stagingSize(0),
+  staged(0),
+  stagingOffset(0),
+  io(nullptr),
+  ioOffset(0) {
     if (nullptr == file)
         throw Exception(std::string("could not open file ") + path);
+
+#ifndef _WIN32
+    // we buffer on our own and write chunks to the descriptor directly
+    setvbuf(file, nullptr, _IONBF, 0);
+
+#ifdef O_DIRECT
+    if (direct) {
+        // fopen created and truncated the file already; if the file system
+        // does not support direct I/O, we keep writing through stdio
+        const int fd = open(path.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+        if (fd >= 0) {
+            stagingSize = std::max(flushSize, DIRECT_ALIGNMENT);
+            stagingSize = (stagingSize + DIRECT_ALIGNMENT - 1) &
+                          ~(DIRECT_ALIGNMENT - 1);
+
+            void *p;
+            if (posix_memalign(&p, DIRECT_ALIGNMENT, stagingSize)) {
+                ::close(fd);
+                fclose(file);
+                throw std::bad_alloc();
+            }
+            staging = static_cast<uint8_t *>(p);
+            directFd = fd;
+        }
+    }
+#endif
+
+    if (async && !staging)
+        io = IOBackend::open();
+#endif
 }
 
+FileOutputStream::FileOutputStream(std::vector<uint8_t> &target) :
+  Stream(&buffer, static_cast<void*>(&buffer + BUFFER_SIZE)),
+  path(),
+  file(nullptr),
+  memory(&target),
+  chunks(nullptr),
+  bytesWriten(0),
+  flushSize(DEFAULT_FLUSH_SIZE),
+  directFd(-1),
+  staging(nullptr),
+  stagingSize(0),
+  staged(0),
+  stagingOffset(0),
+  io(nullptr),
+  ioOffset(0) {}
+
+FileOutputStream::FileOutputStream(ChunkList &target) :
+  Stream(&buffer, static_cast<void*>(&buffer + BUFFER_SIZE)),
+  path(),
+  file(nullptr),
+  memory(nullptr),
+  chunks(&target),
+  bytesWriten(0),
+  flushSize(DEFAULT_FLUSH_SIZE),
+  directFd(-1),
+  staging(nullptr),
+  stagingSize(0),
+  staged(0),
+  stagingOffset(0),
+  io(nullptr),
+  ioOffset(0) {}
+
 FileOutputStream::~FileOutputStream() {
-    if (file)
-        fclose(file);
+    if (file) {
+        try {
+            close();
+        } catch (...) {
+            // there is no way to report errors here
+        }
+    }
+}
+
+void FileOutputStream::close() {
+    if (!file) {
+        // streams writing to memory have nothing to release
+        if (base != position)
+            flush();
+        return;
+    }
+
+    try {
+        if (base != position)
+            flush();
+
+#ifndef _WIN32
+        if (io)
+            io->drain();
+
+        if (staging) {
+            const size_t size = stagingOffset + staged;
+
+            // the tail is written as a padded block and cut off afterwards
+            if (staged) {
+                const size_t padded = (staged + DIRECT_ALIGNMENT - 1) &
+                                      ~(DIRECT_ALIGNMENT - 1);
+                std::memset(staging + staged, 0, padded - staged);
+                struct iovec iov = {staging, padded};
+                off_t at = stagingOffset;
+                writeFully(directFd, &iov, 1, &at);
+            }
+
+            if (ftruncate(fileno(file), size))
+                throw Exception(std::string("truncate failed: ") +
+                                std::strerror(errno));
+        }
+#endif
+    } catch (...) {
+        release();
+        throw;
+    }
+
+    if (release())
+        throw Exception(std::string("could not close file ") + path);
+}
+
+bool FileOutputStream::release() noexcept {
+#ifndef _WIN32
+    // waits for writes in flight
+    delete io;
+    io = nullptr;
+
+    if (staging) {
+        ::close(directFd);
+        directFd = -1;
+        free(staging);
+        staging = nullptr;
+    }
+#endif
+    const bool failed = fclose(file);
+    file = nullptr;
+    return failed;
 }
 
 void FileOutputStream::flush() {
     // prevent double flushs
     assert(base != position);
 
-    fwrite(base, 1, position - (uint8_t *)base, file);
+    sink(base, position - (uint8_t *)base);
     bytesWriten += position - (uint8_t *)base;
     position = (uint8_t *)base;
 }
 
-void FileOutputStream::write(BufferedOutStream *out) {
+void FileOutputStream::sink(const void *data, size_t size) {
+    if (memory) {
+        memory->insert(memory->end(), (const uint8_t *)data,
+                       (const uint8_t *)data + size);
+        return;
+    }
+    if (chunks) {
+        chunks->copy(data, size);
+        return;
+    }
+#ifndef _WIN32
+    if (staging) {
+        stage(data, size);
+        return;
+    }
+    if (io) {
+        io->write(fileno(file), new CopyWrite(data, size), ioOffset);
+        ioOffset += size;
+        return;
+    }
+#endif
+    fwrite(data, 1, size, file);
+}
+
+void FileOutputStream::stage(const void *data, size_t size) {
+#ifndef _WIN32
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    while (size) {
+        const size_t n = std::min(size, stagingSize - staged);
+        std::memcpy(staging + staged, p, n);
+        staged += n;
+        p += n;
+        size -= n;
+
+        if (staged == stagingSize) {
+            struct iovec iov = {staging, stagingSize};
+            off_t at = stagingOffset;
+            writeFully(directFd, &iov, 1, &at);
+            stagingOffset += stagingSize;
+            staged = 0;
+        }
+    }
+#endif
+}
+
+void FileOutputStream::writeChunks(BufferedOutStream *out) {
+    std::unique_ptr<BufferedOutStream> owner(out);
+    if (memory || chunks) {
+        if (base != position)
+            flush();
+
+        if (chunks) {
+            chunks->take(owner.release());
+        } else {
+            for (BufferedOutStream::Buffer &data : out->completed)
+                memory->insert(memory->end(), data.begin,
+                               data.begin + std::abs(data.size));
+        }
+        return;
+    }
+#ifdef _WIN32
     if (base != position)
         flush();
 
-    bytesWriten += out->bytesWriten;
-
-    // write completed buffers
     for (BufferedOutStream::Buffer &data : out->completed) {
         // there is no need to distinguish wrapped from buffered data here
         int size = std::abs(data.size);
         fwrite(data.begin, 1, size, file);
     }
+#else
+    const size_t pending = position - (uint8_t *)base;
+    bytesWriten += pending;
+    position = (uint8_t *)base;
+    if (io)
+        submit(base, pending, owner.release());
+    else
+        gather(base, pending, out, nullptr);
+#endif
+}
 
-    delete out;
+#ifndef _WIN32
+void FileOutputStream::gather(void *prefix, size_t prefixSize,
+                              BufferedOutStream *out, off_t *at) {
+    if (staging) {
+        assert(!at);
+        stage(prefix, prefixSize);
+        for (BufferedOutStream::Buffer &data : out->completed)
+            stage(data.begin, std::abs(data.size));
+        return;
+    }
+
+    struct iovec iov[IOV_BATCH];
+    int count = 0;
+    size_t bytes = prefixSize;
+    if (bytes)
+        iov[count++] = {prefix, bytes};
+
+    for (BufferedOutStream::Buffer &data : out->completed) {
+        if (IOV_BATCH == count || bytes >= flushSize) {
+            writeFully(fileno(file), iov, count, at);
+            count = 0;
+            bytes = 0;
+        }
+
+        // there is no need to distinguish wrapped from buffered data here
+        const size_t size = std::abs(data.size);
+        iov[count++] = {data.begin, size};
+        bytes += size;
+    }
+
+    if (count)
+        writeFully(fileno(file), iov, count, at);
 }
 
-void FileOutputStream::writeSized(BufferedOutStream *out) {
-    assert(out->bytesWriten > 1);
+void FileOutputStream::submit(void *prefix, size_t prefixSize,
+                              BufferedOutStream *out) {
+    const std::shared_ptr<BufferedOutStream> owner(out);
 
-    // @note write has been called before writeSized, hence base == position
-    bytesWriten += out->bytesWriten;
-    v64(out->bytesWriten - 2);
-    flush();
+    std::unique_ptr<ChunkWrite> w(new ChunkWrite(owner));
+    size_t bytes = prefixSize;
+    if (bytes) {
+        // the buffer of this stream is reused before the write completes
+        w->prefix.assign((uint8_t *)prefix, (uint8_t *)prefix + bytes);
+        w->iov.push_back({w->prefix.data(), bytes});
+    }
 
-    // write completed buffers
     for (BufferedOutStream::Buffer &data : out->completed) {
+        if ((size_t)IOV_BATCH == w->iov.size() || bytes >= flushSize) {
+            io->write(fileno(file), w.release(), ioOffset);
+            ioOffset += bytes;
+            w.reset(new ChunkWrite(owner));
+            bytes = 0;
+        }
+
         // there is no need to distinguish wrapped from buffered data here
-        int size = std::abs(data.size);
-        fwrite(data.begin, 1, size, file);
+        const size_t size = std::abs(data.size);
+        w->iov.push_back({data.begin, size});
+        bytes += size;
     }
 
+    io->write(fileno(file), w.release(), ioOffset);
+    ioOffset += bytes;
+}
+
+void FileOutputStream::writeSizedAt(BufferedOutStream *out,
+                                    std::atomic<size_t> &next) {
+    assert(out->bytesWriten > 1);
+
+    std::unique_ptr<BufferedOutStream> owner(out);
+    if (staging)
+        throw std::logic_error("positional writes are not supported by direct streams");
+
+    uint8_t header[9];
+    const size_t headerSize = encodeV64(header, out->bytesWriten - 2);
+
+    off_t at = next.fetch_add(headerSize + out->bytesWriten);
+    gather(header, headerSize, out, &at);
+}
+
+void FileOutputStream::truncate(size_t size) {
+    if (ftruncate(fileno(file), size))
+        throw Exception(std::string("truncate failed: ") +
+                        std::strerror(errno));
+    bytesWriten = size;
+}
+#else
+void FileOutputStream::writeSizedAt(BufferedOutStream *out,
+                                    std::atomic<size_t> &next) {
     delete out;
+    throw std::logic_error("positional writes are not supported");
+}
+
+void FileOutputStream::truncate(size_t size) {
+    throw std::logic_error("positional writes are not supported");
+}
+#endif
+
+void FileOutputStream::write(BufferedOutStream *out) {
+    bytesWriten += out->bytesWriten;
+    writeChunks(out);
+}
+
+void FileOutputStream::writeSized(BufferedOutStream *out) {
+    assert(out->bytesWriten > 1);
+
+    // @note write has been called before writeSized, hence base == position
+    bytesWriten += out->bytesWriten;
+    v64(out->bytesWriten - 2);
+    writeChunks(out);
 }
@@ -6,8 +6,21 @@
 #define SKILL_CPP_COMMON_FILEOUTPUTSTREAM_H
 
 #include <assert.h>
+#include <atomic>
 #include <cstring>
 #include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+#if defined(__BMI2__) || defined(__LZCNT__)
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #include "Stream.h"
 #include "../api/String.h"
@@ -19,6 +32,10 @@ namespace ogss {
 
         class BufferedOutStream;
 
+        class ChunkList;
+
+        class IOBackend;
+
         /**
          * File out streams manages file; uses a buffer for its write operations.
          * Can create a map of correct size for mapped streams.
@@ -34,18 +51,102 @@ namespace ogss {
             const std::string path;
 
             /**
-             * the file object used for communication to the fs
+             * the file object used for communication to the fs; nullptr if the
+             * stream writes to memory
              */
-            FILE *const file;
+            FILE *file;
+
+            //! the buffer receiving all bytes, if the stream writes to memory
+            std::vector<uint8_t> *const memory;
+
+            //! the list receiving all chunks, if the stream writes to memory
+            ChunkList *const chunks;
 
             //! number of bytes written to the file; used for truncation on close
             size_t bytesWriten;
 
+            //! the maximum number of bytes handed to the OS at once
+            const size_t flushSize;
+
+            /**
+             * a descriptor of the file bypassing the page cache, or -1 if the
+             * stream writes through stdio
+             */
+            int directFd;
+
+            /**
+             * Aligned buffer collecting the bytes of a direct stream. It is
+             * written once full; the remainder is padded on close.
+             */
+            uint8_t *staging;
+
+            //! the capacity of staging; a multiple of DIRECT_ALIGNMENT
+            size_t stagingSize;
+
+            //! the number of bytes held by staging
+            size_t staged;
+
+            //! the file offset of the first byte of staging
+            size_t stagingOffset;
+
+            /**
+             * the backend receiving all writes of this stream, or nullptr if
+             * writes are performed synchronously
+             */
+            IOBackend *io;
+
+            //! the file offset of the next byte handed to io
+            size_t ioOffset;
+
+            /**
+             * hand bytes to the file; used for all data not passed via gather
+             */
+            void sink(const void *data, size_t size);
+
+            /**
+             * append bytes to staging, writing it whenever it is full
+             */
+            void stage(const void *data, size_t size);
+
+            /**
+             * free all resources without writing pending bytes
+             *
+             * @return true, iff closing the file failed
+             */
+            bool release() noexcept;
+
             /**
              * flush the buffer
              */
             void flush();
 
+            /**
+             * Write the buffer followed by the completed chunks of out. Chunks
+             * are gathered into as few system calls as IOV_MAX and flushSize
+             * permit.
+             *
+             * @note out is deleted as well
+             */
+            void writeChunks(BufferedOutStream *out);
+
+#ifndef _WIN32
+            /**
+             * Write prefix followed by the completed chunks of out.
+             *
+             * @param at if not null, the file offset to write to; the position
+             * of the file is not used in this case
+             */
+            void gather(void *prefix, size_t prefixSize, BufferedOutStream *out,
+                        off_t *at);
+
+            /**
+             * Hand prefix followed by the completed chunks of out to io.
+             *
+             * @note takes ownership of out
+             */
+            void submit(void *prefix, size_t prefixSize, BufferedOutStream *out);
+#endif
+
             inline void require(size_t i) {
                 if (!has(i))
                     flush();
@@ -54,20 +155,141 @@ namespace ogss {
             //! the backing buffer (allocate plain to get rid of one pointer deref)
             uint8_t buffer[BUFFER_SIZE];
 
+            //! number of leading zeros of v; v must not be zero
+            static inline unsigned clz64(uint64_t v) noexcept {
+#if defined(__LZCNT__)
+                return (unsigned) _lzcnt_u64(v);
+#elif defined(_MSC_VER)
+                unsigned long r;
+                _BitScanReverse64(&r, v);
+                return 63U - (unsigned) r;
+#else
+                return (unsigned) __builtin_clzll(v);
+#endif
+            }
+
+            /**
+             * Distribute the low 56 bits of v to the 7-bit payloads of eight
+             * little-endian bytes.
+             */
+            static inline uint64_t spread7(uint64_t v) noexcept {
+#ifdef __BMI2__
+                return _pdep_u64(v, 0x7f7f7f7f7f7f7f7fULL);
+#else
+                uint64_t w = v & 0x00ffffffffffffffULL;
+                w = ((w & 0x00fffffff0000000ULL) << 4U) | (w & 0x000000000fffffffULL);
+                w = ((w & 0x0fffc0000fffc000ULL) << 2U) | (w & 0x00003fff00003fffULL);
+                w = ((w & 0x3f803f803f803f80ULL) << 1U) | (w & 0x007f007f007f007fULL);
+                return w;
+#endif
+            }
+
+            /**
+             * Encode v as v64 to target without branching over its bytes.
+             *
+             * @note the caller guarantees that nine bytes are writable at target
+             * @return the number of bytes used
+             */
+            static inline unsigned encodeV64(uint8_t *target, uint64_t v) noexcept {
+                if (v < 0x80U) {
+                    *target = (uint8_t) v;
+                    return 1;
+                }
+
+                // 7 payload bits per byte, the ninth byte holds eight
+                unsigned length = (70U - clz64(v)) / 7U;
+                if (length > 9)
+                    length = 9;
+
+                // set continuation bits of all but the last of the first
+                // eight bytes
+                uint64_t w = spread7(v);
+                if (length < 9) {
+                    w |= 0x0080808080808080ULL >> (8U * (8U - length));
+                } else {
+                    w |= 0x8080808080808080ULL;
+                    target[8] = (uint8_t) (v >> 56U);
+                }
+                std::memcpy(target, &w, 8);
+                return length;
+            }
+
         public:
 
+            //! the default maximum number of bytes handed to the OS at once
+            static constexpr size_t DEFAULT_FLUSH_SIZE = 8u << 20u;
+
+            /**
+             * the alignment of offsets, sizes and addresses of direct writes;
+             * sufficient for all common logical block sizes
+             */
+            static constexpr size_t DIRECT_ALIGNMENT = 4096;
+
+            //! true, iff writeSizedAt and truncate are supported
+#ifdef _WIN32
+            static constexpr bool POSITIONAL_WRITES = false;
+#else
+            static constexpr bool POSITIONAL_WRITES = true;
+#endif
+
             /**
              * open the file at the target location
              *
-             * @param append set to true, if content shall be appended to the file
+             * @param flushSize the maximum number of bytes handed to the OS at
+             * once when writing buffered streams
+             * @param direct if true, the file is written bypassing the page
+             * cache in aligned blocks of flushSize bytes, if the platform and
+             * file system support it; the stream falls back to regular writes
+             * otherwise
+             * @param async if true, writes are submitted to an asynchronous
+             * IOBackend, if one is available and direct is false; chunks of
+             * written buffered streams are released once they are on disk
+             */
+            explicit FileOutputStream(const std::string &path,
+                                      size_t flushSize = DEFAULT_FLUSH_SIZE,
+                                      bool direct = false, bool async = false);
+
+            /**
+             * append all bytes to a buffer in memory
+             */
+            explicit FileOutputStream(std::vector<uint8_t> &target);
+
+            /**
+             * append all bytes to a chunk list; chunks of written buffered
+             * streams are moved to the list instead of being copied
              */
-            FileOutputStream(const std::string &path);
+            explicit FileOutputStream(ChunkList &target);
 
             /**
              * close the stream
              */
             virtual ~FileOutputStream();
 
+            /**
+             * Write pending bytes and close the file.
+             *
+             * @note the destructor closes the stream as well, but cannot report
+             * errors
+             */
+            void close();
+
+            /**
+             * @return true, iff the page cache is bypassed; in this case,
+             * positional writes are not supported
+             */
+            bool direct() const noexcept {
+                return directFd >= 0;
+            }
+
+            /**
+             * @return true, iff writeSizedAt and truncate can be used, i.e. iff
+             * the platform supports them and the stream writes to a file
+             * without bypassing the page cache
+             */
+            bool positionalWrites() const noexcept {
+                return POSITIONAL_WRITES && file && !direct();
+            }
+
             /**
              * total file size
              */
@@ -100,6 +322,24 @@ namespace ogss {
              */
             void writeSized(BufferedOutStream *out);
 
+            /**
+             * Write a BufferdOutStream prepending it with its size in bytes to
+             * a range of the file reserved from next. The range is independent
+             * of the position of this stream.
+             *
+             * @note out is deleted as well
+             * @note this can be called by multiple threads concurrently
+             * @note not supported by direct streams
+             * @param next the offset of the next free byte of the file
+             */
+            void writeSizedAt(BufferedOutStream *out, std::atomic<size_t> &next);
+
+            /**
+             * Set the size of the file. Used after data has been written with
+             * writeSizedAt.
+             */
+            void truncate(size_t size);
+
             inline void i8(int8_t v) {
                 require(1);
                 *(position++) = (uint8_t) v;
@@ -125,50 +365,8 @@ namespace ogss {
             }
 
             inline void v64(int64_t p) {
-                auto v = ::ogss::unsign(p);
                 require(9);
-
-                if (v < 0x80U) {
-                    *(position++) = (uint8_t) (v);
-                } else {
-                    *(position++) = (uint8_t) ((0x80U | v));
-                    if (v < 0x4000U) {
-                        *(position++) = (uint8_t) ((v >> 7u));
-                    } else {
-                        *(position++) = (uint8_t) ((0x80U | v >> 7u));
-                        if (v < 0x200000U) {
-                            *(position++) = (uint8_t) ((v >> 14u));
-                        } else {
-                            *(position++) = (uint8_t) ((0x80U | v >> 14u));
-                            if (v < 0x10000000U) {
-                                *(position++) = (uint8_t) ((v >> 21u));
-                            } else {
-                                *(position++) = (uint8_t) ((0x80U | v >> 21u));
-                                if (v < 0x800000000U) {
-                                    *(position++) = (uint8_t) ((v >> 28u));
-                                } else {
-                                    *(position++) = (uint8_t) ((0x80U | v >> 28u));
-                                    if (v < 0x40000000000U) {
-                                        *(position++) = (uint8_t) ((v >> 35u));
-                                    } else {
-                                        *(position++) = (uint8_t) ((0x80U | v >> 35u));
-                                        if (v < 0x2000000000000U) {
-                                            *(position++) = (uint8_t) ((v >> 42u));
-                                        } else {
-                                            *(position++) = (uint8_t) ((0x80U | v >> 42u));
-                                            if (v < 0x100000000000000U) {
-                                                *(position++) = (uint8_t) ((v >> 49u));
-                                            } else {
-                                                *(position++) = (uint8_t) ((0x80U | v >> 49u));
-                                                *(position++) = (uint8_t) ((v >> 56u));
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
+                position += encodeV64(position, ::ogss::unsign(p));
             }
 
             inline void put(const api::String s) {
@@ -177,7 +375,7 @@ namespace ogss {
                     if (base != position) {
                         flush();
                     }
-                    fwrite(s->c_str(), 1, size, file);
+                    sink(s->c_str(), size);
                     bytesWriten += size;
                 } else {
                     require(size);
@@ -0,0 +1,338 @@
+//
+// Created on 17.10.26.
+//
+
+#include "IOBackend.h"
+
+#ifndef _WIN32
+
+#include "../api/Exception.h"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// madvise requests require the interface of Linux 5.6 or later
+#ifdef IORING_FEAT_FAST_POLL
+#define OGSS_IO_URING
+#endif
+#endif
+#endif
+
+#ifdef OGSS_IO_URING
+#include <algorithm>
+#include <climits>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace ogss::streams;
+
+size_t IOBackend::Write::size() const noexcept {
+    size_t r = 0;
+    for (size_t i = first; i < iov.size(); i++)
+        r += iov[i].iov_len;
+    return r;
+}
+
+bool IOBackend::Write::advance(size_t n) noexcept {
+    offset += n;
+    while (first < iov.size() && n >= iov[first].iov_len) {
+        n -= iov[first].iov_len;
+        first++;
+    }
+    if (first == iov.size())
+        return false;
+
+    iov[first].iov_base = (uint8_t *)iov[first].iov_base + n;
+    iov[first].iov_len -= n;
+    return true;
+}
+
+void IOBackend::write(int fd, Write *request, uint64_t offset) {
+    std::unique_ptr<Write> owner(request);
+    request->fd = fd;
+    request->offset = offset;
+    request->first = 0;
+    if (request->size())
+        submit(owner.release());
+}
+
+#ifdef OGSS_IO_URING
+namespace {
+
+//! number of entries of the submission queue; bounds requests in flight
+constexpr unsigned DEPTH = 64;
+
+/**
+ * A backend submitting requests to an io_uring instance. Each request is
+ * submitted on its own, i.e. the kernel starts working on it immediately.
+ */
+class URing final : public IOBackend {
+    const int ring;
+
+    //! the mapped rings and submission entries
+    void *sqMap, *cqMap;
+    size_t sqMapSize, cqMapSize;
+    io_uring_sqe *sqes;
+
+    unsigned *sqHead, *sqTail, sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, cqMask;
+    io_uring_cqe *cqes;
+
+    //! protects the rings and all fields below
+    std::mutex lock;
+
+    //! number of submitted requests not yet completed
+    unsigned inFlight;
+
+    //! the first error reported for a write; empty if there was none
+    std::string error;
+
+    URing(int ring, const io_uring_params &p);
+
+  public:
+    static URing *open();
+
+    ~URing() final;
+
+    void willNeed(const void *begin, size_t size) final;
+
+    void drain() final;
+
+  protected:
+    void submit(Write *request) final;
+
+  private:
+    //! @return the next free submission entry; waits for completions if
+    //! required
+    io_uring_sqe *next();
+
+    //! hand the entry returned by next to the kernel
+    //! @note entries are withdrawn, if the kernel rejects them
+    void push(io_uring_sqe *sqe);
+
+    //! remove entries the kernel has not consumed and delete their requests
+    void withdraw();
+
+    //! prepare the write of the remaining bytes of request
+    void prepare(Write *request);
+
+    //! process available completions; waits for one if wait is true
+    void reap(bool wait);
+};
+
+URing::URing(int ring, const io_uring_params &p) :
+  ring(ring),
+  sqMap(MAP_FAILED),
+  cqMap(MAP_FAILED),
+  sqMapSize(p.sq_off.array + p.sq_entries * sizeof(unsigned)),
+  cqMapSize(p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe)),
+  sqes((io_uring_sqe *)MAP_FAILED),
+  lock(),
+  inFlight(0),
+  error() {
+    const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+        sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+
+    sqMap = mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+    if (MAP_FAILED == sqMap)
+        return;
+
+    cqMap = single ? sqMap
+                   : mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    if (MAP_FAILED == cqMap)
+        return;
+
+    sqes = (io_uring_sqe *)mmap(nullptr, p.sq_entries * sizeof(io_uring_sqe),
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, ring,
+                                IORING_OFF_SQES);
+
+    uint8_t *const sq = (uint8_t *)sqMap;
+    sqHead = (unsigned *)(sq + p.sq_off.head);
+    sqTail = (unsigned *)(sq + p.sq_off.tail);
+    sqMask = *(unsigned *)(sq + p.sq_off.ring_mask);
+    sqArray = (unsigned *)(sq + p.sq_off.array);
+
+    uint8_t *const cq = (uint8_t *)cqMap;
+    cqHead = (unsigned *)(cq + p.cq_off.head);
+    cqTail = (unsigned *)(cq + p.cq_off.tail);
+    cqMask = *(unsigned *)(cq + p.cq_off.ring_mask);
+    cqes = (io_uring_cqe *)(cq + p.cq_off.cqes);
+}
+
+URing *URing::open() {
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    const int ring = (int)syscall(__NR_io_uring_setup, DEPTH, &p);
+    if (ring < 0)
+        return nullptr;
+
+    URing *r = new URing(ring, p);
+    if (MAP_FAILED == (void *)r->sqes) {
+        delete r;
+        return nullptr;
+    }
+    return r;
+}
+
+URing::~URing() {
+    // the kernel may still use the memory of requests in flight
+    try {
+        std::lock_guard<std::mutex> guard(lock);
+        while (inFlight)
+            reap(true);
+    } catch (...) {
+        // there is no way to report errors here
+    }
+
+    if (MAP_FAILED != (void *)sqes)
+        munmap(sqes, DEPTH * sizeof(io_uring_sqe));
+    if (MAP_FAILED != cqMap && cqMap != sqMap)
+        munmap(cqMap, cqMapSize);
+    if (MAP_FAILED != sqMap)
+        munmap(sqMap, sqMapSize);
+    close(ring);
+}
+
+void URing::willNeed(const void *begin, size_t size) {
+    std::lock_guard<std::mutex> guard(lock);
+    io_uring_sqe *const sqe = next();
+    sqe->opcode = IORING_OP_MADVISE;
+    sqe->addr = (uintptr_t)begin;
+    sqe->len = (unsigned)std::min<size_t>(size, UINT_MAX);
+    sqe->fadvise_advice = MADV_WILLNEED;
+    // advice has no request; its result is irrelevant
+    sqe->user_data = 0;
+    push(sqe);
+}
+
+void URing::drain() {
+    std::lock_guard<std::mutex> guard(lock);
+    while (inFlight)
+        reap(true);
+
+    if (!error.empty()) {
+        std::string e;
+        e.swap(error);
+        throw ogss::Exception("write failed: " + e);
+    }
+}
+
+void URing::submit(Write *request) {
+    std::lock_guard<std::mutex> guard(lock);
+    prepare(request);
+}
+
+io_uring_sqe *URing::next() {
+    // keeping requests in flight below DEPTH keeps both queues from overflowing
+    while (inFlight == DEPTH)
+        reap(true);
+
+    io_uring_sqe *const sqe = sqes + (*sqTail & sqMask);
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    return sqe;
+}
+
+void URing::push(io_uring_sqe *sqe) {
+    const unsigned tail = *sqTail;
+    sqArray[tail & sqMask] = (unsigned)(sqe - sqes);
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    inFlight++;
+
+    while (syscall(__NR_io_uring_enter, ring, 1, 0, 0, nullptr, 0) < 0) {
+        if (EINTR == errno)
+            continue;
+        if (EAGAIN == errno || EBUSY == errno) {
+            reap(false);
+            continue;
+        }
+        const std::string e = std::strerror(errno);
+        withdraw();
+        throw ogss::Exception("io_uring_enter failed: " + e);
+    }
+}
+
+void URing::withdraw() {
+    const unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    unsigned tail = *sqTail;
+    while (tail != head) {
+        tail--;
+        inFlight--;
+        delete (Write *)(uintptr_t)sqes[sqArray[tail & sqMask]].user_data;
+    }
+    __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+}
+
+void URing::prepare(Write *request) {
+    io_uring_sqe *const sqe = next();
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = request->fd;
+    sqe->off = request->offset;
+    sqe->addr = (uintptr_t)(request->iov.data() + request->first);
+    sqe->len = std::min<size_t>(request->iov.size() - request->first, IOV_MAX);
+    sqe->user_data = (uintptr_t)request;
+    push(sqe);
+}
+
+void URing::reap(bool wait) {
+    if (wait) {
+        while (syscall(__NR_io_uring_enter, ring, 0, 1, IORING_ENTER_GETEVENTS,
+                       nullptr, 0) < 0) {
+            if (EINTR != errno)
+                throw ogss::Exception(std::string("io_uring_enter failed: ") +
+                                      std::strerror(errno));
+        }
+    }
+
+    // resubmissions may reap completions, i.e. head is read again each time
+    unsigned head;
+    while ((head = *cqHead) != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe cqe = cqes[head & cqMask];
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        inFlight--;
+
+        Write *const request = (Write *)(uintptr_t)cqe.user_data;
+        if (!request)
+            continue;
+
+        if (cqe.res < 0) {
+            if (-EINTR == cqe.res || -EAGAIN == cqe.res) {
+                prepare(request);
+                continue;
+            }
+            if (error.empty())
+                error = std::strerror(-cqe.res);
+            delete request;
+
+        } else if (request->advance(cqe.res)) {
+            // resume partial writes
+            prepare(request);
+
+        } else {
+            delete request;
+        }
+    }
+}
+} // namespace
+#endif
+
+IOBackend *IOBackend::open() {
+#ifdef OGSS_IO_URING
+    return URing::open();
+#else
+    return nullptr;
+#endif
+}
+
+#endif
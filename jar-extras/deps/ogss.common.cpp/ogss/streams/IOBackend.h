@@ -0,0 +1,96 @@
+//
+// Created on 17.10.26.
+//
+
+#ifndef OGSS_COMMON_CPP_STREAMS_IOBACKEND_H
+#define OGSS_COMMON_CPP_STREAMS_IOBACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+namespace ogss {
+namespace streams {
+
+#ifndef _WIN32
+/**
+ * Performs file I/O of streams asynchronously. Streams use a backend if one is
+ * available and perform their I/O synchronously otherwise.
+ *
+ * @note all operations are thread-safe
+ */
+class IOBackend {
+  public:
+    /**
+     * A write handed to a backend. The backend deletes it once all of its
+     * bytes have been written. Hence, subclasses can own the data written.
+     */
+    struct Write {
+        //! the data to be written
+        std::vector<struct iovec> iov;
+
+        Write() : iov(), fd(-1), offset(0), first(0) {}
+
+        virtual ~Write() = default;
+
+        //! @return the number of bytes described by iov
+        size_t size() const noexcept;
+
+        /*
+         * the following fields are managed by the backend
+         */
+
+        int fd;
+
+        //! the file offset of the first byte not yet written
+        uint64_t offset;
+
+        //! the index of the first element of iov not yet written
+        size_t first;
+
+        //! drop the first n bytes; @return true, iff bytes remain
+        bool advance(size_t n) noexcept;
+    };
+
+    virtual ~IOBackend() = default;
+
+    /**
+     * Write request to offset of fd. The call returns once the request has
+     * been submitted.
+     *
+     * @note takes ownership of request
+     */
+    void write(int fd, Write *request, uint64_t offset);
+
+    /**
+     * Tell the OS that the pages of a mapped range will be read soon. The call
+     * does not wait for the pages.
+     */
+    virtual void willNeed(const void *begin, size_t size) = 0;
+
+    /**
+     * Wait until all writes are complete.
+     *
+     * @throws ogss::Exception if a write failed
+     */
+    virtual void drain() = 0;
+
+    /**
+     * @return a backend using io_uring, or nullptr if the kernel does not
+     * support it
+     */
+    static IOBackend *open();
+
+  protected:
+    //! submit request; request->fd and offset are set already
+    virtual void submit(Write *request) = 0;
+};
+#endif
+} // namespace streams
+} // namespace ogss
+
+#endif // OGSS_COMMON_CPP_STREAMS_IOBACKEND_H
@@ -6,8 +6,17 @@
 #define SKILL_CPP_COMMON_INSTREAM_H
 
 #include <cstring>
+#include <stdexcept>
 #include <string>
 
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define OGSS_VARINT_SIMD
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 #include "../api/Box.h"
 #include "../api/Exception.h"
 #include "../api/String.h"
@@ -38,6 +47,169 @@ class InStream : public Stream {
      */
     uint8_t off;
 
+#if defined(__AVX2__)
+    //! number of bytes inspected at once by the bulk varint decoder
+    static constexpr unsigned VARINT_WINDOW = 32;
+
+    //! bit i is set iff byte i of the window has its continuation bit set
+    static inline uint64_t continuationBits(const uint8_t *p) noexcept {
+        return (uint32_t)_mm256_movemask_epi8(
+          _mm256_loadu_si256((const __m256i *)p));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    //! number of bytes inspected at once by the bulk varint decoder
+    static constexpr unsigned VARINT_WINDOW = 16;
+
+    //! bit i is set iff byte i of the window has its continuation bit set
+    static inline uint64_t continuationBits(const uint8_t *p) noexcept {
+        return (uint32_t)_mm_movemask_epi8(
+          _mm_loadu_si128((const __m128i *)p));
+    }
+#endif
+
+    static inline unsigned ctz64(uint64_t v) noexcept {
+#ifdef _MSC_VER
+        unsigned long r;
+        _BitScanForward64(&r, v);
+        return (unsigned)r;
+#else
+        return (unsigned)__builtin_ctzll(v);
+#endif
+    }
+
+    /**
+     * Concatenate the 7-bit payloads of the eight little-endian bytes in w.
+     */
+    static inline uint64_t compact7(uint64_t w) noexcept {
+#ifdef __BMI2__
+        return _pext_u64(w, 0x7f7f7f7f7f7f7f7fULL);
+#else
+        w &= 0x7f7f7f7f7f7f7f7fULL;
+        w = ((w & 0x7f007f007f007f00ULL) >> 1U) | (w & 0x007f007f007f007fULL);
+        w = ((w & 0x3fff00003fff0000ULL) >> 2U) | (w & 0x00003fff00003fffULL);
+        w = ((w & 0x0fffffff00000000ULL) >> 4U) | (w & 0x000000000fffffffULL);
+        return w;
+#endif
+    }
+
+    /**
+     * Expand the bits of the given bytes to one boolean per bit, LSB first.
+     */
+    static inline void unpackBooleans(bool *target, const uint8_t *bytes,
+                                      size_t count) noexcept {
+        static_assert(sizeof(bool) == 1, "booleans are expected to be bytes");
+#ifdef __AVX2__
+        // 32 booleans at once: broadcast four bytes, select byte i/8 for
+        // boolean i and test its bit i%8
+        const __m256i select = _mm256_setr_epi64x(
+          0x0000000000000000LL, 0x0101010101010101LL, 0x0202020202020202LL,
+          0x0303030303030303LL);
+        const __m256i bit = _mm256_set1_epi64x((int64_t)0x8040201008040201ULL);
+        const __m256i one = _mm256_set1_epi8(1);
+        for (; count >= 4; count -= 4, bytes += 4, target += 32) {
+            int32_t w;
+            std::memcpy(&w, bytes, 4);
+            __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(w), select);
+            v = _mm256_min_epu8(_mm256_and_si256(v, bit), one);
+            _mm256_storeu_si256((__m256i *)target, v);
+        }
+#endif
+        for (; count; count--, target += 8) {
+            const uint64_t b = *(bytes++);
+#ifdef __BMI2__
+            const uint64_t w = _pdep_u64(b, 0x0101010101010101ULL);
+#else
+            // isolate bit i in byte i, then map nonzero bytes to 1
+            const uint64_t x = (b * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+            const uint64_t w =
+              ((((x & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) | x) >> 7U) &
+              0x0101010101010101ULL;
+#endif
+            std::memcpy(target, &w, 8);
+        }
+    }
+
+    /**
+     * Decode a varint of known length without branching over its bytes.
+     *
+     * @note the caller guarantees that at least nine bytes are readable at p
+     */
+    static inline uint64_t decodeVarint(const uint8_t *p,
+                                        unsigned length) noexcept {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        if (length < 8)
+            w &= (((uint64_t)1U) << (8U * length)) - 1U;
+        uint64_t v = compact7(w);
+        if (length > 8)
+            v |= (uint64_t)p[8] << 56U;
+        return v;
+    }
+
+    /**
+     * @return true, iff the varint of the given length at p fits into 32 bits,
+     * i.e. iff v32 would accept it
+     */
+    static inline bool fitsV32(const uint8_t *p, unsigned length) noexcept {
+        return length < 5 || (5 == length && p[4] <= 0xf);
+    }
+
+    /**
+     * Decode count consecutive varints into target. While enough bytes are
+     * left, the length of a varint is taken from its continuation bits, that
+     * are inspected for a whole window at once if SIMD is available. Only the
+     * last few bytes of the stream are decoded with checked scalar reads.
+     *
+     * @note if isV32, values are required to fit into 32 bits
+     */
+    template <typename T, bool isV32>
+    inline void varints(T *target, size_t count) {
+#ifdef OGSS_VARINT_SIMD
+        while (count && has(VARINT_WINDOW)) {
+            const uint64_t cont = continuationBits(position);
+            if (!cont) {
+                // a window of single-byte values, i.e. small IDs and sizes
+                const size_t n = count < VARINT_WINDOW ? count : VARINT_WINDOW;
+                for (size_t j = 0; j < n; j++)
+                    target[j] = (T)position[j];
+                target += n;
+                position += n;
+                count -= n;
+                continue;
+            }
+
+            // any value starting at least nine bytes before the end of the
+            // window lies completely inside of it
+            const uint64_t stops = ~cont;
+            unsigned offset = 0;
+            do {
+                unsigned length = ctz64(stops >> offset) + 1;
+                if (length > 9)
+                    length = 9;
+                if (isV32 && !fitsV32(position + offset, length))
+                    throw std::logic_error("value not v32");
+                *(target++) = (T)decodeVarint(position + offset, length);
+                offset += length;
+            } while (--count && offset <= VARINT_WINDOW - 9);
+            position += offset;
+        }
+#endif
+        while (count && has(9)) {
+            uint64_t w;
+            std::memcpy(&w, position, 8);
+            const uint64_t stops = ~w & 0x8080808080808080ULL;
+            const unsigned length = stops ? (ctz64(stops) >> 3U) + 1 : 9;
+            if (isV32 && !fitsV32(position, length))
+                throw std::logic_error("value not v32");
+            *(target++) = (T)decodeVarint(position, length);
+            position += length;
+            count--;
+        }
+        while (count--) {
+            *(target++) = isV32 ? (T)v32() : (T)v64();
+        }
+    }
+
   protected:
     InStream(void *base, void *end) : Stream(base, end), off(7) {}
 
@@ -47,17 +219,46 @@ class InStream : public Stream {
      */
     virtual ~InStream() = default;
 
+    /**
+     * Ensure that at least n more bytes can be read from this stream. Reading
+     * values with a total size of at most n bytes can use the checked variants
+     * of the read functions afterwards.
+     *
+     * @note this is used to validate whole blocks of fixed-size data up front
+     */
+    inline void require(size_t n) {
+        ensure(std::less_equal<void *>()(position + n, end));
+    }
+
+    /**
+     * Ensure that count more booleans can be read from this stream.
+     */
+    inline void requireBooleans(size_t count) {
+        const size_t left = 7U - off;
+        if (count > left)
+            require((count - left + 7U) / 8U);
+    }
+
     inline int8_t i8() {
         ensure(position < end);
         return *(position++);
     }
 
+    //! @note checked means checked by the caller!
+    inline int8_t i8checked() noexcept { return *(position++); }
+
     static inline api::Box i8Box(InStream &self) {
         api::Box r = {0};
         r.i8 = self.i8();
         return r;
     }
 
+    static inline api::Box i8checkedBox(InStream &self) noexcept {
+        api::Box r = {0};
+        r.i8 = self.i8checked();
+        return r;
+    }
+
     inline int16_t i16() {
         ensure(position + 1 < end);
         uint16_t r;
@@ -72,6 +273,20 @@ class InStream : public Stream {
         return r;
     }
 
+    //! @note checked means checked by the caller!
+    inline int16_t i16checked() noexcept {
+        uint16_t r;
+        std::memcpy(&r, position, 2);
+        position += 2;
+        return r;
+    }
+
+    static inline api::Box i16checkedBox(InStream &self) noexcept {
+        api::Box r = {0};
+        r.i16 = self.i16checked();
+        return r;
+    }
+
     inline int32_t i32() {
         ensure(position + 3 < end);
         uint32_t r;
@@ -86,6 +301,20 @@ class InStream : public Stream {
         return r;
     }
 
+    //! @note checked means checked by the caller!
+    inline int32_t i32checked() noexcept {
+        uint32_t r;
+        std::memcpy(&r, position, 4);
+        position += 4;
+        return r;
+    }
+
+    static inline api::Box i32checkedBox(InStream &self) noexcept {
+        api::Box r = {0};
+        r.i32 = self.i32checked();
+        return r;
+    }
+
     inline int64_t i64() {
         ensure(position + 7 < end);
         uint64_t r = 0;
@@ -100,6 +329,20 @@ class InStream : public Stream {
         return r;
     }
 
+    //! @note checked means checked by the caller!
+    inline int64_t i64checked() noexcept {
+        uint64_t r = 0;
+        std::memcpy(&r, position, 8);
+        position += 8;
+        return r;
+    }
+
+    static inline api::Box i64checkedBox(InStream &self) noexcept {
+        api::Box r = {0};
+        r.i64 = self.i64checked();
+        return r;
+    }
+
     inline int32_t v32() {
         uint32_t v;
 
@@ -123,9 +366,9 @@ class InStream : public Stream {
                     if (v >= 0x10000000U) {
                         if (position > end)
                             goto FAILURE;
-                        v = (v & 0xfffffffU) | ((uint32_t) * (position) << 28U);
                         if (*position > 0xf)
                             throw std::logic_error("value not v32");
+                        v = (v & 0xfffffffU) | ((uint32_t) * (position++) << 28U);
                     }
                 }
             }
@@ -243,6 +486,32 @@ class InStream : public Stream {
         return v;
     }
 
+    /**
+     * Number of values that callers of v64s are expected to stage in a local
+     * buffer, if they cannot decode into their target directly.
+     */
+    static constexpr int BULK_SIZE = 256;
+
+    /**
+     * Decode count consecutive v64 values into target.
+     *
+     * @note in contrast to calling v64 in a loop, this will check bounds only
+     * for the last few bytes of the stream
+     */
+    inline void v64s(int64_t *target, size_t count) {
+        varints<int64_t, false>(target, count);
+    }
+
+    /**
+     * Decode count consecutive v32 values into target.
+     *
+     * @note in contrast to calling v32 in a loop, this will check bounds only
+     * for the last few bytes of the stream
+     */
+    inline void v32s(int32_t *target, size_t count) {
+        varints<int32_t, true>(target, count);
+    }
+
     static inline api::Box v64Box(InStream &self) {
         api::Box r = {0};
         r.i64 = self.v64();
@@ -267,6 +536,26 @@ class InStream : public Stream {
         return result.f;
     }
 
+    //! @note checked means checked by the caller!
+    inline float f32checked() noexcept {
+        union {
+            int32_t i;
+            float f;
+        } result = {0};
+        result.i = i32checked();
+        return result.f;
+    }
+
+    //! @note checked means checked by the caller!
+    inline double f64checked() noexcept {
+        union {
+            int64_t i;
+            double f;
+        } result = {0};
+        result.i = i64checked();
+        return result.f;
+    }
+
     inline bool boolean() {
         if (8 == ++off) {
             off = 0;
@@ -278,12 +567,54 @@ class InStream : public Stream {
         return 0 != ((*(position - 1)) & (1u << off));
     }
 
+    //! @note checked means checked by the caller!
+    inline bool booleanchecked() noexcept {
+        if (8 == ++off) {
+            off = 0;
+            position++;
+        }
+
+        return 0 != ((*(position - 1)) & (1u << off));
+    }
+
+    /**
+     * Read count consecutive booleans into target.
+     *
+     * @note the range is checked once; whole bytes are expanded to eight
+     * booleans at once
+     */
+    inline void booleans(bool *target, size_t count) {
+        requireBooleans(count);
+
+        // finish the current byte
+        while (count && 7 != off) {
+            *(target++) = booleanchecked();
+            count--;
+        }
+
+        const size_t bytes = count / 8U;
+        unpackBooleans(target, position, bytes);
+        position += bytes;
+        target += 8U * bytes;
+        count -= 8U * bytes;
+
+        while (count--) {
+            *(target++) = booleanchecked();
+        }
+    }
+
     static inline api::Box boolBox(InStream &self) {
         api::Box r = {0};
         r.boolean = self.boolean();
         return r;
     }
 
+    static inline api::Box boolcheckedBox(InStream &self) noexcept {
+        api::Box r = {0};
+        r.boolean = self.booleanchecked();
+        return r;
+    }
+
     /**
      * create a string from the stream
      * @note the caller owns the string!
@@ -298,6 +629,18 @@ class InStream : public Stream {
         return rval;
     }
 
+    /**
+     * view a string inside of the stream without copying it
+     * @note does not move position
+     * @note the offset is absolute and can be before position
+     */
+    api::StringView view(uint32_t offset, uint32_t length) const {
+        ensure((bool)(offset > 0) &
+               (bool)((uint8_t *)base + offset + length <= (uint8_t *)end));
+
+        return api::StringView{(const char *)base + offset, length};
+    }
+
     /**
      * read a literal string from the stream
      * @note the caller owns the string!
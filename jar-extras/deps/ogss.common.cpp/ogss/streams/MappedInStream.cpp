@@ -2,15 +2,64 @@
 // Created by Timm Felden on 04.11.15.
 //
 
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "MappedInStream.h"
 
 ogss::streams::MappedInStream::MappedInStream(
-        void *base, uint8_t *position, void *end)
-        : InStream(base, end) {
+        void *base, uint8_t *position, void *end, void *buffer, bool advised)
+        : InStream(base, end), buffer(buffer), advised(advised ? position : nullptr) {
     this->position = position;
 }
 
 ogss::streams::MappedInStream::MappedInStream(const ogss::streams::MappedInStream *other, size_t begin, size_t end)
-        : InStream(other->position + begin, other->position + end) {
+        : InStream(other->position + begin, other->position + end), buffer(nullptr), advised(nullptr) {
     this->position = (uint8_t *) base;
 }
+
+ogss::streams::MappedInStream::~MappedInStream() {
+    free(buffer);
+}
+
+#ifndef _WIN32
+static const uintptr_t pageMask = ~(uintptr_t) (sysconf(_SC_PAGESIZE) - 1);
+#endif
+
+void ogss::streams::MappedInStream::willNeed() const {
+#ifndef _WIN32
+    const auto pages = neededPages();
+    if (pages.second)
+        madvise((void *) pages.first, pages.second, MADV_WILLNEED);
+#endif
+}
+
+std::pair<const void *, size_t> ogss::streams::MappedInStream::neededPages() const {
+#ifndef _WIN32
+    if (advised) {
+        // round outwards; requesting a shared page twice is harmless
+        const uintptr_t first = (uintptr_t) position & pageMask;
+        const uintptr_t last = (uintptr_t) end;
+        if (first < last)
+            return std::make_pair((const void *) first, (size_t) (last - first));
+    }
+#endif
+    return std::make_pair((const void *) nullptr, (size_t) 0);
+}
+
+void ogss::streams::MappedInStream::dontNeed() const {
+#ifndef _WIN32
+    if (!advised)
+        return;
+
+    // round inwards, because adjacent blocks may still be read
+    const uintptr_t first = ((uintptr_t) advised + ~pageMask) & pageMask;
+    const uintptr_t last = (uintptr_t) end & pageMask;
+    if (first < last)
+        madvise((void *) first, last - first, MADV_DONTNEED);
+#endif
+}
@@ -7,6 +7,8 @@
 
 #include "InStream.h"
 
+#include <utility>
+
 namespace ogss::streams {
 class FileInputStream;
 
@@ -17,21 +19,63 @@ class MappedInStream : public InStream {
   private:
     friend class FileInputStream;
 
+    /**
+     * a buffer holding the data of this stream, if it was not mapped
+     * @note owned by this
+     */
+    void *buffer;
+
+    /**
+     * the begin of this block, iff it is part of a large mapped file whose
+     * pages are requested and dropped per block; nullptr otherwise
+     */
+    const uint8_t *advised;
+
     //! only file input streams can create mapped streams
-    MappedInStream(void *base, uint8_t *position, void *end);
+    MappedInStream(void *base, uint8_t *position, void *end,
+                   void *buffer = nullptr, bool advised = false);
 
   public:
     // copy a mapped in stream for later use
     explicit MappedInStream(const MappedInStream *other) :
-      InStream(other->base, other->end) {
+      InStream(other->base, other->end), buffer(nullptr), advised(nullptr) {
         this->position = other->position;
     }
 
     //! create a view of another mapped stream
     MappedInStream(const MappedInStream *other, size_t begin, size_t end);
 
-    //! requires no action; all resources are managed elsewhere
-    ~MappedInStream() override = default;
+    //! frees the buffer, if any; all other resources are managed elsewhere
+    ~MappedInStream() override;
+
+    /**
+     * Tell the OS that the remaining bytes of this stream will be read soon.
+     * @note no-op, unless the stream is part of a large mapped file
+     */
+    void willNeed() const;
+
+    /**
+     * @return the pages requested by willNeed; empty, unless the stream is part
+     * of a large mapped file
+     */
+    std::pair<const void *, size_t> neededPages() const;
+
+    /**
+     * @return the bytes not yet read from this stream
+     */
+    std::pair<const uint8_t *, size_t> remaining() const {
+        return {position, (size_t)((uint8_t *)end - position)};
+    }
+
+    /**
+     * Tell the OS that the bytes of this stream will not be read again, i.e.
+     * that its pages can be dropped from memory. Pages shared with adjacent
+     * blocks are kept.
+     * @note no-op, unless the stream is part of a large mapped file
+     * @note must not be called while a LazyField or the StringPool may still
+     * read from the stream
+     */
+    void dontNeed() const;
 };
 } // namespace ogss::streams
 
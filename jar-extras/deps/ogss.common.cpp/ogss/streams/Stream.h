@@ -27,8 +27,9 @@ namespace ogss {
             /**
              * base pointer of the stream.
              * We keep the base pointer, because it is required for unmap and sane error reporting.
+             * @note base and end are only moved by streamed file input streams
              */
-            void *const base;
+            void *base;
 
             /**
              * position inside of the stream
@@ -37,7 +38,7 @@ namespace ogss {
             /**
              * end pointer of the stream. The stream is done, if position reached end.
              */
-            void *const end;
+            void *end;
 
             Stream(void *base, void *end) : base(base), position((uint8_t*)base), end(end) { }
 
@@ -59,6 +60,13 @@ namespace ogss {
                 return std::greater_equal<void*>()(position, end);
             }
 
+            /**
+             * true, iff the stream has been read up to its end but not past it
+             */
+            inline bool consumed() const noexcept {
+                return position == end;
+            }
+
             inline bool has(size_t amountLeft) const noexcept {
                 return std::less<void*>()(position + amountLeft, end);
             }
@@ -162,6 +162,10 @@ trait AbstractBackEnd extends BackEnd {
    * setter name
    */
   protected[cpp] def setter(f : FieldLike) : String = s"set${escaped(capital(f.name))}"
+  /**
+   * name of the declarations of a field in all files
+   */
+  protected[cpp] def declarations(f : FieldLike) : String = s"declarationsOf${escaped(capital(f.name))}"
   protected def knownField(f : Field) : String = escaped(s"KF_${capital(f.owner.name)}_${camel(f.name)}")
 
   /**
@@ -60,16 +60,32 @@ ${packageParts.mkString("namespace ", " {\nnamespace ", " {")}
       }
                     ::ogss::internal::AbstractPool *const owner);
 
-            virtual ::ogss::api::Box getR(const ::ogss::api::Object *i) {
+            virtual ::ogss::api::Box getR(const ::ogss::api::Object *i) {${
+        if (f.isTransient) ""
+        else """
+                ensureIsLoaded();"""
+      }
                 return ::ogss::api::box(((${mapType(t)})i)->${name(f)});
             }
 
-            virtual void setR(::ogss::api::Object *i, ::ogss::api::Box v) {
-                ((${mapType(t)})i)->${name(f)} = (${mapType(f.`type`)})v.${unbox(f.`type`)};
+            virtual void setR(::ogss::api::Object *i, ::ogss::api::Box v) {${
+        if (f.isTransient) ""
+        else """
+                ensureIsLoaded();"""
+      }
+                ((${mapType(t)})i)->${name(f)} = (${mapType(f.`type`)})v.${unbox(f.`type`)};${
+        if (f.isTransient) ""
+        else """
+                markChanged(i);"""
+      }
             }
 ${
         if (f.isTransient) ""
-        else """
+        else s"""
+            ::ogss::internal::Declarations *declarations() const final {
+                return &${name(t)}::${declarations(f)};
+            }
+
             virtual bool check() const;
 
     protected:
@@ -96,6 +112,8 @@ $endGuard""")
       val out = files.open(s"${name(base)}FieldDeclarations.cpp")
 
       out.write(s"""
+#include <algorithm>
+
 #include <ogss/fieldTypes/ArrayType.h>
 #include <ogss/fieldTypes/ListType.h>
 #include <ogss/fieldTypes/SetType.h>
@@ -111,7 +129,6 @@ ${
 
           val fieldName = s"$packageName::internal::${knownField(f)}"
           val accessI = s"d[i++]->${name(f)}"
-          val readI = s"$accessI = ${readType(f.`type`)};"
           s"""
 $fieldName::${knownField(f)}(
         const ::ogss::fieldTypes::FieldType *const type,${
@@ -131,19 +148,17 @@ $fieldName::${knownField(f)}(
 ${
             if (f.isTransient) ""
             else s"""
+::ogss::internal::Declarations $packageName::${name(t)}::${declarations(f)};
+
 void $fieldName::read(int i, const int last, ::ogss::streams::MappedInStream &in) const {
     auto d = ((${access(t)} *) owner)->data;
-    while (i != last) {
-        $readI
-    }
+    ${readCode(accessI, f)}
 }
 
 bool $fieldName::write(int i, const int last, ::ogss::streams::BufferedOutStream *out) const {
     ${mapType(t)}* d = ((${access(t)}*) owner)->data;
     bool drop = true;
-    while (i != last) {
-        ${writeCode(accessI, f)}
-    }
+    ${writeLoop(accessI, f)}
     return drop;
 }
 
@@ -171,6 +186,56 @@ $checks
     }
   }
 
+  /**
+   * create the read loop; bools, v64 and references are decoded in bulk,
+   * fixed-size builtins are decoded without bounds checks after validating the
+   * block
+   */
+  private final def readCode(accessI : String, f : Field) : String = {
+    // (staged type, bulk decoder, conversion of v[j])
+    val bulk = f.`type` match {
+      case t : BuiltinType if "bool" == lowercase(t.name) ⇒ Some(("bool", "booleans", "v[j]"))
+      case t : BuiltinType if "v64" == lowercase(t.name) ⇒ Some(("int64_t", "v64s", "v[j]"))
+      case t : ClassDef ⇒ Some(("int64_t", "v64s",
+        s"(${mapType(t)}) ((const ::ogss::internal::AbstractPool *) type)->getAsAnnotation((::ogss::ObjectID) v[j])"))
+      case _ ⇒ None
+    }
+    bulk match {
+      case Some((staged, decoder, value)) ⇒ s"""$staged v[::ogss::streams::InStream::BULK_SIZE];
+    while (i != last) {
+        const int n = std::min((int) ::ogss::streams::InStream::BULK_SIZE, last - i);
+        in.$decoder(v, n);
+        for (int j = 0; j < n; j++)
+            $accessI = $value;
+    }"""
+      case None ⇒ f.`type` match {
+        // fixed-size data is validated once for the whole block
+        case t : BuiltinType if fixedSize.contains(lowercase(t.name)) ⇒
+          val n = lowercase(t.name)
+          s"""in.require(${fixedSize(n)} * (size_t) (last - i));
+    while (i != last) {
+        $accessI = in.${n}checked();
+    }"""
+
+        case t ⇒ s"""while (i != last) {
+        $accessI = ${readType(t)};
+    }"""
+      }
+    }
+  }
+
+  /**
+   * size in bytes of builtin types that are read with a single check per block
+   */
+  private final val fixedSize = Map(
+    "i8" -> 1,
+    "i16" -> 2,
+    "i32" -> 4,
+    "i64" -> 8,
+    "f32" -> 4,
+    "f64" -> 8
+  )
+
   /**
    * choose a good parse expression
    *
@@ -205,6 +270,50 @@ $checks
     }
   }
 
+  /**
+   * create the write loop; bools are packed and v64 and references are encoded
+   * in bulk
+   */
+  private def writeLoop(accessI : String, f : Field) : String = f.`type` match {
+    case t : BuiltinType if "bool" == lowercase(t.name) ⇒ s"""bool v[::ogss::streams::InStream::BULK_SIZE];
+    while (i != last) {
+        const int n = std::min((int) ::ogss::streams::InStream::BULK_SIZE, last - i);
+        for (int j = 0; j < n; j++) {
+            v[j] = $accessI;
+            drop &= !v[j];
+        }
+        out->booleans(v, n);
+    }"""
+
+    case t : BuiltinType if "v64" == lowercase(t.name) ⇒ s"""int64_t v[::ogss::streams::InStream::BULK_SIZE];
+    while (i != last) {
+        const int n = std::min((int) ::ogss::streams::InStream::BULK_SIZE, last - i);
+        for (int j = 0; j < n; j++) {
+            v[j] = $accessI;
+            drop &= !v[j];
+        }
+        out->v64s(v, n);
+    }"""
+
+    case t : ClassDef ⇒ s"""int64_t v[::ogss::streams::InStream::BULK_SIZE];
+    while (i != last) {
+        const int n = std::min((int) ::ogss::streams::InStream::BULK_SIZE, last - i);
+        for (int j = 0; j < n; j++) {
+            ${mapType(t)} r = $accessI;
+            if (r) {
+                v[j] = objectID(r);
+                drop = false;
+            } else
+                v[j] = 0;
+        }
+        out->v64s(v, n);
+    }"""
+
+    case _ ⇒ s"""while (i != last) {
+        ${writeCode(accessI, f)}
+    }"""
+  }
+
   private def writeCode(accessI : String, f : Field) : String = f.`type` match {
     case t : BuiltinType ⇒ lowercase(t.name) match {
       case "anyref" | "string" ⇒ s"""const auto v = $accessI;
@@ -213,17 +322,9 @@ $checks
                 drop = false;
             } else
                 out->i8(0);"""
-      case "bool" ⇒ s"const bool v = $accessI;drop &= !v;out->boolean(v);"
       case n      ⇒ s"const auto v = $accessI;drop &= !v;out->$n(v);"
     }
 
-    case t : ClassDef ⇒ s"""${mapType(t)} v = $accessI;
-        if (v) {
-            out->v64(objectID(v));
-            drop = false;
-        } else
-            out->i8(0);"""
-
     case t : ListType ⇒ s"drop &= ((ogss::fieldTypes::ListType<${mapType(t.baseType)}>*)type)->w(::ogss::api::box($accessI), out);"
 
     case _            ⇒ s"""drop &= type->w(::ogss::api::box($accessI), out);"""
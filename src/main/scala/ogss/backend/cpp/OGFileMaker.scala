@@ -35,6 +35,7 @@ trait OGFileMaker extends AbstractBackEnd {
 
     out.write(s"""${beginGuard("file")}
 #include <ogss/api/File.h>
+#include <ogss/api/Projection.h>
 #include <ogss/fieldTypes/ArrayType.h>
 #include <ogss/fieldTypes/ListType.h>
 #include <ogss/fieldTypes/SetType.h>
@@ -68,8 +69,49 @@ ${
 
             /**
              * Reads a binary OGSS file and turns it into an instance of this class.
+             *
+             * @note jobs of the parser and of the file are run by executor; nullptr
+             * selects the process-wide ::ogss::concurrent::Pool::shared()
+             * @note only fields selected by projection are decoded; nullptr selects all
+             * fields. Other fields hold default values until they are loaded, e.g. by
+             * loadLazyData. Changing them before is an error.
              */
-            static File *open(const std::string &path, uint8_t mode = ::ogss::api::ReadMode::read | ::ogss::api::WriteMode::write);
+            static File *open(const std::string &path, uint8_t mode = ::ogss::api::ReadMode::read | ::ogss::api::WriteMode::write,
+                              ::ogss::concurrent::Executor *executor = nullptr,
+                              const ::ogss::api::Projection *projection = nullptr);
+
+            /**
+             * Reads a binary OGSS file from a file descriptor owned by the caller.
+             * Descriptors that cannot be mapped, e.g. pipes, are read sequentially.
+             *
+             * @note the path has to be set with changePath before flushing
+             */
+            static File *open(int fd, uint8_t mode = ::ogss::api::WriteMode::write,
+                              ::ogss::concurrent::Executor *executor = nullptr,
+                              const ::ogss::api::Projection *projection = nullptr);
+
+            /**
+             * Reads a binary OGSS file from a buffer in memory without copying it.
+             *
+             * @note the buffer is owned by the caller and must outlive the file or
+             * its loadLazyData
+             * @note the path has to be set with changePath before flushing
+             * @note this is not an overload of open, because open(path, mode) would
+             * resolve to it
+             */
+            static File *openBuffer(const void *buffer, size_t size, uint8_t mode = ::ogss::api::WriteMode::write,
+                                    ::ogss::concurrent::Executor *executor = nullptr,
+                                    const ::ogss::api::Projection *projection = nullptr);
+
+            /**
+             * Reads a binary OGSS file sequentially from a source that cannot be mapped.
+             *
+             * @note takes ownership of source
+             * @note the path has to be set with changePath before flushing
+             */
+            static File *open(::ogss::streams::ByteSource *source, uint8_t mode = ::ogss::api::WriteMode::write,
+                              ::ogss::concurrent::Executor *executor = nullptr,
+                              const ::ogss::api::Projection *projection = nullptr);
 
         private:
 
@@ -217,9 +259,31 @@ ${packageParts.mkString("namespace ", " {\nnamespace ", " {")}
     }
 ${packageParts.map(_ ⇒ "}").mkString}
 
-$packageName::api::File *$packageName::api::File::open(const std::string &path, uint8_t mode) {
+$packageName::api::File *$packageName::api::File::open(const std::string &path, uint8_t mode,
+                                                          ::ogss::concurrent::Executor *executor,
+                                                          const ::ogss::api::Projection *projection) {
+    $packageName::internal::PB pb;
+    return new $packageName::api::File(::ogss::internal::StateInitializer::make(path, pb, mode, executor, projection));
+}
+
+$packageName::api::File *$packageName::api::File::open(int fd, uint8_t mode, ::ogss::concurrent::Executor *executor,
+                                                          const ::ogss::api::Projection *projection) {
+    $packageName::internal::PB pb;
+    return new $packageName::api::File(::ogss::internal::StateInitializer::make(fd, pb, mode, executor, projection));
+}
+
+$packageName::api::File *$packageName::api::File::openBuffer(const void *buffer, size_t size, uint8_t mode,
+                                                                ::ogss::concurrent::Executor *executor,
+                                                                const ::ogss::api::Projection *projection) {
+    $packageName::internal::PB pb;
+    return new $packageName::api::File(::ogss::internal::StateInitializer::make(buffer, size, pb, mode, executor, projection));
+}
+
+$packageName::api::File *$packageName::api::File::open(::ogss::streams::ByteSource *source, uint8_t mode,
+                                                          ::ogss::concurrent::Executor *executor,
+                                                          const ::ogss::api::Projection *projection) {
     $packageName::internal::PB pb;
-    return new $packageName::api::File(::ogss::internal::StateInitializer::make(path, pb, mode));
+    return new $packageName::api::File(::ogss::internal::StateInitializer::make(source, pb, mode, executor, projection));
 }
 
 $packageName::api::File::File(::ogss::internal::StateInitializer *init)
@@ -31,6 +31,20 @@ trait TypesMaker extends AbstractBackEnd {
 
   @inline private final def localFieldName(implicit f : Field) : String = name(f)
 
+  /**
+   * load f in the file of this, if the file has deferred it
+   */
+  private final def load(f : Field) : String =
+    if (f.isTransient) ""
+    else s"${declarations(f)}.ensureIsLoaded(this); "
+
+  /**
+   * load f in the file of this and record the change made by a setter
+   */
+  private final def change(f : Field) : String =
+    if (f.isTransient) ""
+    else s"${declarations(f)}.change(this); "
+
   abstract override def make {
     super.make
 
@@ -53,6 +67,7 @@ trait TypesMaker extends AbstractBackEnd {
       out.write(s"""${beginGuard(s"types_of_${name(base)}")}
 #include <ogss/api/types.h>
 #include <ogss/api/Exception.h>
+#include <ogss/internal/Declarations.h>
 #include <ogss/internal/EnumPool.h>
 #include <cassert>
 #include <vector>
@@ -141,6 +156,12 @@ ${packageParts.mkString("namespace ", " {\nnamespace ", " {")}
           yield s"""    ${mapType(f.`type`)} ${localFieldName(f)};
 """).mkString)
 
+        // declarations of fields stored in files
+        out.write((for (f ← t.fields if !f.isTransient)
+          yield s"""
+        static ::ogss::internal::Declarations ${declarations(f)};
+""").mkString)
+
         // constructor
         out.write(s"""
         $Name() { }
@@ -194,23 +215,23 @@ ${packageParts.mkString("namespace ", " {\nnamespace ", " {")}
         for (f ← t.fields) {
           f.`type` match {
             case ft : EnumDef ⇒ out.write(s"""
-        ${comment(f)}inline ${name(ft)} ${getter(f)}() const { return ${name(f)}->value(); }
-        ${comment(f)}inline ${mapType(ft)} ${getter(f)}Proxy() const { return ${name(f)}; }
+        ${comment(f)}inline ${name(ft)} ${getter(f)}() const { ${load(f)}return ${name(f)}->value(); }
+        ${comment(f)}inline ${mapType(ft)} ${getter(f)}Proxy() const { ${load(f)}return ${name(f)}; }
         ${comment(f)}inline void ${setter(f)}(${name(ft)} ${name(f)}) {
-            assert(${name(ft)}::UNKNOWN != ${name(f)} && nullptr != this->${name(f)});
+            ${change(f)}assert(${name(ft)}::UNKNOWN != ${name(f)} && nullptr != this->${name(f)});
             this->${name(f)} = (${mapType(ft)}) this->${name(f)}->owner->proxy((ogss::EnumBase)${name(f)});
         }
         ${comment(f)}inline void ${setter(f)}Proxy(${mapType(ft)} ${name(f)}) {
-            assert(nullptr != this->${name(f)});
+            ${change(f)}assert(nullptr != this->${name(f)});
             if(nullptr == ${name(f)}) this->${name(f)} = (${mapType(ft)}) this->${name(f)}->owner->proxy(0);
             else if(this->${name(f)}->owner == ${name(f)}->owner) this->${name(f)} = ${name(f)};
             else if(${name(ft)}::UNKNOWN != ${name(f)}->value()) this->${name(f)} = (${mapType(ft)}) this->${name(f)}->owner->proxy((ogss::EnumBase)${name(f)}->value());
-            else throw new std::logic_error("one cannot set an unknown enum value from a different state"); 
+            else throw new std::logic_error("one cannot set an unknown enum value from a different state");
         }
 """)
 
             case ft ⇒ out.write(s"""
-        ${comment(f)}inline ${mapType(ft)} ${getter(f)}() const { return ${name(f)}; }
+        ${comment(f)}inline ${mapType(ft)} ${getter(f)}() const { ${load(f)}return ${name(f)}; }
         ${comment(f)}inline void ${setter(f)}(${mapType(ft)} ${name(f)}) {${
               "" /*
           f.getRestrictions.asScala.map {
@@ -232,7 +253,7 @@ ${packageParts.mkString("namespace ", " {\nnamespace ", " {")}
 
             case _ ⇒ ""
           }.mkString*/
-            }this->${name(f)} = ${name(f)};}
+            }${change(f)}this->${name(f)} = ${name(f)};}
 """)
           }
         }
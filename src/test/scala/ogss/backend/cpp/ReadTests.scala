@@ -88,6 +88,202 @@ using ::$packageName::api::File;
     out.close
   }
 
+  /**
+   * helpers of read-write tests; they compare states reflectively
+   */
+  private val readWriteHelpers = """
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ogss/internal/DataField.h>
+#include <ogss/internal/LazyField.h>
+#include <ogss/iterators/FieldIterator.h>
+
+//! @return the bytes of the file at path
+static std::vector<uint8_t> bytesOf(const char *path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+//! a source that yields a few bytes per read, like a pipe
+class PipeSource final : public ::ogss::streams::ByteSource {
+    const std::vector<uint8_t> bytes;
+    size_t position;
+
+public:
+    explicit PipeSource(std::vector<uint8_t> bytes) : bytes(std::move(bytes)), position(0) {}
+
+    size_t read(void *target, size_t size) override {
+        const size_t n = std::min(std::min(size, (size_t) 4093), bytes.size() - position);
+        std::memcpy(target, bytes.data() + position, n);
+        position += n;
+        return n;
+    }
+};
+
+//! @return true, iff x and y are equal values of type t; references are compared by presence
+static bool sameValue(::ogss::TypeID t, ::ogss::api::Box x, ::ogss::api::Box y) {
+    switch (t) {
+        case ::ogss::KnownTypeID::BOOL:
+            return x.boolean == y.boolean;
+        case ::ogss::KnownTypeID::I8:
+            return x.i8 == y.i8;
+        case ::ogss::KnownTypeID::I16:
+            return x.i16 == y.i16;
+        case ::ogss::KnownTypeID::I32:
+            return x.i32 == y.i32;
+        case ::ogss::KnownTypeID::I64:
+        case ::ogss::KnownTypeID::V64:
+            return x.i64 == y.i64;
+        case ::ogss::KnownTypeID::F32:
+            return !std::memcmp(&x.f32, &y.f32, sizeof(float));
+        case ::ogss::KnownTypeID::F64:
+            return !std::memcmp(&x.f64, &y.f64, sizeof(double));
+        case ::ogss::KnownTypeID::STRING:
+            return x.string == y.string || (x.string && y.string && *x.string == *y.string);
+        default:
+            return !x.anyRef == !y.anyRef;
+    }
+}
+
+//! @return v changed, if t is a boolean or an integer type; v otherwise
+static ::ogss::api::Box changed(::ogss::TypeID t, ::ogss::api::Box v) {
+    switch (t) {
+        case ::ogss::KnownTypeID::BOOL:
+            v.boolean = !v.boolean;
+            break;
+        case ::ogss::KnownTypeID::I8:
+            v.i8++;
+            break;
+        case ::ogss::KnownTypeID::I16:
+            v.i16++;
+            break;
+        case ::ogss::KnownTypeID::I32:
+            v.i32++;
+            break;
+        case ::ogss::KnownTypeID::I64:
+        case ::ogss::KnownTypeID::V64:
+            v.i64++;
+            break;
+        default:
+            break;
+    }
+    return v;
+}
+
+//! @return true, iff t is a fixed size integer type and v is not zero; blocks of zeros are not written
+static bool nonZero(::ogss::TypeID t, ::ogss::api::Box v) {
+    switch (t) {
+        case ::ogss::KnownTypeID::I8:
+            return v.i8;
+        case ::ogss::KnownTypeID::I16:
+            return v.i16;
+        case ::ogss::KnownTypeID::I32:
+            return v.i32;
+        case ::ogss::KnownTypeID::I64:
+            return v.i64;
+        default:
+            return false;
+    }
+}
+
+//! change the first object of each type; with keepLayout, only values are changed that keep the size of blocks
+static void changeFirstObjects(::ogss::api::File &s, bool keepLayout) {
+    for (::ogss::internal::AbstractPool *p : s) {
+        const auto os = p->allObjects();
+        if (!os->hasNext())
+            continue;
+        ::ogss::api::Object *const o = os->next();
+        for (auto fs = p->allFields(); fs.hasNext();) {
+            const auto f = fs.next();
+            if (!dynamic_cast<::ogss::internal::DataField *>(f))
+                continue;
+
+            const ::ogss::api::Box v = f->getR(o);
+            const ::ogss::api::Box w = changed(f->type->typeID, v);
+            if (!keepLayout || (nonZero(f->type->typeID, v) && nonZero(f->type->typeID, w)))
+                f->setR(o, w);
+        }
+    }
+}
+
+//! @return the fields of s that have not been loaded and whose blocks are copied on write
+static std::vector<::ogss::internal::DataField *> copiedFields(::ogss::api::File &s) {
+    std::vector<::ogss::internal::DataField *> r;
+    for (::ogss::internal::AbstractPool *p : s) {
+        for (auto fs = p->allFields(); fs.hasNext();) {
+            const auto f = dynamic_cast<::ogss::internal::DataField *>(fs.next());
+            if (f && f->owner == p && !f->isLoaded() && !dynamic_cast<::ogss::internal::LazyField *>(f) &&
+                (f->type->typeID <= ::ogss::KnownTypeID::F64 || dynamic_cast<const ::ogss::internal::AbstractPool *>(f->type)))
+                r.push_back(f);
+        }
+    }
+    return r;
+}
+
+//! write s to out and read the written file
+static std::unique_ptr<File> written(File &s, std::vector<uint8_t> &out) {
+    s.flush(out);
+    std::unique_ptr<File> c(File::openBuffer(out.data(), out.size()));
+    c->check();
+    return c;
+}
+
+//! expect that a and b hold the same objects with the same field values
+static void expectSameState(::ogss::api::File &a, ::ogss::api::File &b) {
+    for (::ogss::internal::AbstractPool *p : a) {
+        ::ogss::internal::AbstractPool *const q = b.pool(p->name);
+        ASSERT_NE(nullptr, q) << *p->name;
+        ASSERT_EQ(p->size(), q->size()) << *p->name;
+
+        std::unordered_map<std::string, ::ogss::internal::FieldDeclaration *> fields;
+        for (auto fs = q->allFields(); fs.hasNext();) {
+            const auto f = fs.next();
+            fields[*f->name] = f;
+        }
+
+        const auto xs = p->allObjects();
+        const auto ys = q->allObjects();
+        while (xs->hasNext()) {
+            ::ogss::api::Object *const x = xs->next();
+            ::ogss::api::Object *const y = ys->next();
+            for (auto fs = p->allFields(); fs.hasNext();) {
+                const auto f = fs.next();
+                if (dynamic_cast<::ogss::internal::DataField *>(f))
+                    EXPECT_TRUE(sameValue(f->type->typeID, f->getR(x), fields.at(*f->name)->getR(y)))
+                        << *p->name << "." << *f->name;
+            }
+        }
+    }
+}
+"""
+
+  /**
+   * write a test of an accepted binary f; body is created from the quoted path of f
+   */
+  private def makeReadWriteTest(out : PrintWriter, name : String, kind : String, f : File)(body : String ⇒ String) {
+    val path = "\"../../" + f.getPath.replaceAll("\\\\", "\\\\\\\\") + "\""
+    out.write(s"""
+TEST(${gen.escaped(name.capitalize)}_ReadWrite_Test, ${kind}_${f.getName.replaceAll("\\W", "_")}) {
+    try {${body(path)}
+    } catch (ogss::Exception& e) {
+        GTEST_FAIL() << "an exception was thrown:" << std::endl << e.what();
+    }
+    GTEST_SUCCEED();
+}
+""")
+  }
+
   override def makeTests(name : String) {
     val (accept, reject) = collectBinaries(name)
 
@@ -117,6 +313,268 @@ TEST(${gen.escaped(name.capitalize)}_Read_Test, Reject_${f.getName.replaceAll("\
     }
     GTEST_FAIL() << "expected an exception, but none was thrown.";
 }
+""")
+      closeTestFile(out)
+    }
+
+    // generate tests that open accepted binaries in other ways and write them
+    locally {
+      val out = newTestFile(name, "ReadWrite")
+      out.write(readWriteHelpers)
+
+      for (f ← accept) {
+        makeReadWriteTest(out, name, "OpenFD", f) { path ⇒ s"""
+        std::unique_ptr<File> s(File::open($path));
+        const int fd = ::open($path, O_RDONLY);
+        ASSERT_LE(0, fd);
+        std::unique_ptr<File> d(File::open(fd));
+        d->check();
+        expectSameState(*s, *d);
+        ::close(fd);"""
+        }
+
+        makeReadWriteTest(out, name, "OpenBuffer", f) { path ⇒ s"""
+        std::unique_ptr<File> s(File::open($path));
+        const std::vector<uint8_t> bytes = bytesOf($path);
+        std::unique_ptr<File> b(File::openBuffer(bytes.data(), bytes.size()));
+        b->check();
+        expectSameState(*s, *b);"""
+        }
+
+        makeReadWriteTest(out, name, "OpenStream", f) { path ⇒ s"""
+        std::unique_ptr<File> s(File::open($path));
+        std::unique_ptr<File> r(File::open(new PipeSource(bytesOf($path))));
+        r->check();
+        expectSameState(*s, *r);"""
+        }
+
+        makeReadWriteTest(out, name, "ReadOnly", f) { path ⇒ s"""
+        std::unique_ptr<File> s(File::open($path));
+        std::unique_ptr<File> r(File::open($path, ::ogss::api::ReadMode::read | ::ogss::api::WriteMode::readOnly));
+        r->check();
+        expectSameState(*s, *r);
+
+        // read-only files cannot be written, not even to memory
+        std::vector<uint8_t> out;
+        EXPECT_THROW(r->flush(out), std::invalid_argument);"""
+        }
+
+        makeReadWriteTest(out, name, "Delete", f) { path ⇒ s"""
+        std::unique_ptr<File> s(File::open($path));
+
+        // delete every other object
+        size_t n = 0;
+        for (::ogss::internal::AbstractPool *p : *s) {
+            for (const auto os = p->allObjects(); os->hasNext();) {
+                ::ogss::api::Object *const o = os->next();
+                if (s->pool(o) == p && n++ % 2)
+                    s->free(o);
+            }
+        }
+
+        std::unordered_map<std::string, ::ogss::ObjectID> sizes;
+        for (::ogss::internal::AbstractPool *p : *s) {
+            ::ogss::ObjectID size = 0;
+            for (const auto os = p->allObjects(); os->hasNext();)
+                if (!os->next()->isDeleted())
+                    size++;
+            sizes[*p->name] = size;
+        }
+
+        std::vector<uint8_t> out;
+        std::unique_ptr<File> c(written(*s, out));
+        for (::ogss::internal::AbstractPool *p : *c)
+            EXPECT_EQ(sizes[*p->name], p->size()) << *p->name;"""
+        }
+
+        makeReadWriteTest(out, name, "Copy", f) { path ⇒ s"""
+        std::unique_ptr<File> s(File::open($path));
+
+        // blocks of streamed files are encoded, i.e. they get the layout of this implementation
+        std::unique_ptr<File> r(File::open(new PipeSource(bytesOf($path))));
+        std::vector<uint8_t> bytes;
+        std::unique_ptr<File> d(written(*r, bytes));
+        expectSameState(*s, *d);
+
+        // unchanged blocks are copied, i.e. they are taken from the buffer, even
+        // if other values have been put there after reading it
+        std::vector<uint8_t> buffer(bytes);
+        std::unique_ptr<File> c(File::openBuffer(buffer.data(), buffer.size()));
+        changeFirstObjects(*d, true);
+        std::vector<uint8_t> other;
+        d->flush(other);
+        ASSERT_EQ(buffer.size(), other.size());
+        std::memcpy(buffer.data(), other.data(), other.size());
+
+        std::vector<uint8_t> out;
+        std::unique_ptr<File> e(written(*c, out));
+        expectSameState(*d, *e);"""
+        }
+
+        makeReadWriteTest(out, name, "Change", f) { path ⇒ s"""
+        std::unique_ptr<File> s(File::open($path));
+
+        // blocks of changed objects must not be copied
+        changeFirstObjects(*s, false);
+
+        std::vector<uint8_t> out;
+        std::unique_ptr<File> c(written(*s, out));
+        expectSameState(*s, *c);"""
+        }
+
+        makeReadWriteTest(out, name, "Projection", f) { path ⇒ s"""
+        std::unique_ptr<File> s(File::open($path));
+
+        // no field is decoded on open
+        const ::ogss::api::Projection none;
+        std::unique_ptr<File> p(File::open($path, ::ogss::api::ReadMode::read | ::ogss::api::WriteMode::write, nullptr, &none));
+        const auto copied = copiedFields(*p);
+
+        // blocks of unchanged fields are copied without decoding them
+        std::vector<uint8_t> out;
+        std::unique_ptr<File> c(written(*p, out));
+        expectSameState(*s, *c);
+        for (const auto f : copied)
+            EXPECT_FALSE(f->isLoaded()) << *f->owner->name << "." << *f->name;
+
+        // reflective access loads fields
+        p->check();
+        expectSameState(*s, *p);"""
+        }
+      }
+      closeTestFile(out)
+    }
+
+    // generate tests of blocks copied on write; they use the types of blocks.skill
+    if ("blocks" == name) {
+      val out = newTestFile(name, "Blocks")
+      out.write("""
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <ogss/api/Projection.h>
+#include <ogss/internal/DataField.h>
+#include <ogss/iterators/FieldIterator.h>
+
+//! instances of Earlier fill the first block of Base except for its last five instances
+static const int earlier = ::ogss::FD_Threshold - 5;
+
+//! @return a file holding instances of Earlier followed by instances of Later with the values 1 to 10
+static std::vector<uint8_t> blocks() {
+    std::unique_ptr<File> f(File::open("blocks.sg", ::ogss::api::ReadMode::create | ::ogss::api::WriteMode::write));
+    for (int i = 0; i < earlier; i++)
+        f->Earlier->make();
+    for (int i = 1; i <= 10; i++)
+        f->Later->build()->value(i)->make();
+
+    std::vector<uint8_t> out;
+    f->flush(out);
+    return out;
+}
+
+//! @return the instances of Later in f
+static std::vector<::blocks::Later *> laters(File &f) {
+    std::vector<::blocks::Later *> r;
+    for (auto &x : f.Later->all())
+        r.push_back(&x);
+    return r;
+}
+
+//! @return the declaration of Later.value in f
+static ::ogss::internal::DataField *valueOf(File &f) {
+    for (auto fs = f.Later->allFields(); fs.hasNext();) {
+        const auto d = dynamic_cast<::ogss::internal::DataField *>(fs.next());
+        if (d && "value" == *d->name)
+            return d;
+    }
+    return nullptr;
+}
+
+TEST(Blocks_Test, ChangeAfterDeletionsInEarlierSibling) {
+    const std::vector<uint8_t> bytes = blocks();
+    std::unique_ptr<File> f(File::openBuffer(bytes.data(), bytes.size()));
+
+    // instances of Later get lower IDs on write
+    int deleted = 0;
+    for (auto &x : f->Earlier->all())
+        if (deleted++ < 10)
+            f->free(&x);
+    laters(*f).back()->setValue(-1);
+
+    std::vector<uint8_t> out;
+    f->flush(out);
+    std::unique_ptr<File> c(File::openBuffer(out.data(), out.size()));
+    ASSERT_EQ(earlier - 10, (int) c->Earlier->size());
+    const auto ls = laters(*c);
+    ASSERT_EQ(10, (int) ls.size());
+    EXPECT_EQ(9, ls[8]->getValue());
+    EXPECT_EQ(-1, ls[9]->getValue());
+}
+
+TEST(Blocks_Test, ProjectionOnOneOfTwoFiles) {
+    const std::vector<uint8_t> bytes = blocks();
+    const ::ogss::api::Projection none;
+    std::unique_ptr<File> a(File::openBuffer(bytes.data(), bytes.size(), ::ogss::api::WriteMode::write, nullptr, &none));
+    std::unique_ptr<File> b(File::openBuffer(bytes.data(), bytes.size()));
+    ASSERT_FALSE(valueOf(*a)->isLoaded());
+
+    // accessors of b neither load nor change a
+    EXPECT_EQ(1, laters(*b)[0]->getValue());
+    EXPECT_FALSE(valueOf(*a)->isLoaded());
+    laters(*b)[0]->setValue(42);
+    a->loadLazyData();
+    EXPECT_EQ(1, laters(*a)[0]->getValue());
+    EXPECT_EQ(42, laters(*b)[0]->getValue());
+
+    // b does not depend on a
+    a.reset();
+    EXPECT_EQ(2, laters(*b)[1]->getValue());
+}
+
+TEST(Blocks_Test, AccessorsLoadProjectedFields) {
+    const std::vector<uint8_t> bytes = blocks();
+    const ::ogss::api::Projection none;
+
+    std::unique_ptr<File> f(File::openBuffer(bytes.data(), bytes.size(), ::ogss::api::WriteMode::write, nullptr, &none));
+    EXPECT_EQ(10, laters(*f)[9]->getValue());
+    EXPECT_TRUE(valueOf(*f)->isLoaded());
+
+    f.reset(File::openBuffer(bytes.data(), bytes.size(), ::ogss::api::WriteMode::write, nullptr, &none));
+    laters(*f)[3]->setValue(-1);
+    EXPECT_TRUE(valueOf(*f)->isLoaded());
+
+    std::vector<uint8_t> out;
+    f->flush(out);
+    std::unique_ptr<File> c(File::openBuffer(out.data(), out.size()));
+    EXPECT_EQ(-1, laters(*c)[3]->getValue());
+    EXPECT_EQ(5, laters(*c)[4]->getValue());
+}
+
+TEST(Blocks_Test, ProjectedBlocksAreCopied) {
+    const std::vector<uint8_t> bytes = blocks();
+
+    // a file of the same layout with other values
+    std::vector<uint8_t> other;
+    {
+        std::unique_ptr<File> g(File::openBuffer(bytes.data(), bytes.size()));
+        for (::blocks::Later *l : laters(*g))
+            l->setValue(l->getValue() + 100);
+        g->flush(other);
+    }
+    ASSERT_EQ(bytes.size(), other.size());
+
+    // blocks outside the projection are taken from the buffer without decoding them
+    std::vector<uint8_t> buffer(bytes);
+    const ::ogss::api::Projection none;
+    std::unique_ptr<File> f(File::openBuffer(buffer.data(), buffer.size(), ::ogss::api::WriteMode::write, nullptr, &none));
+    std::memcpy(buffer.data(), other.data(), other.size());
+
+    std::vector<uint8_t> out;
+    f->flush(out);
+    EXPECT_FALSE(valueOf(*f)->isLoaded());
+    EXPECT_TRUE(out == other);
+}
 """)
       closeTestFile(out)
     }